@@ -0,0 +1,784 @@
+/*!
+ * \brief Opal::Saboteur microbenchmarks
+ *
+ * Measures the Opal::Saboteur lifecycle operations against std::thread
+ * and a condition variable thread pool. Every measurement is reported
+ * as percentiles in nanoseconds.
+ *
+ * \author Carlos L. Cuenca
+ * \version 0.1.0
+ * \date 02/07/2022
+ */
+
+/// --------
+/// Includes
+
+#include<algorithm>
+#include<condition_variable>
+#include<cstdio>
+#include<deque>
+#include<functional>
+#include<sys/resource.h>
+#include<thread>
+#include<vector>
+#include<Opal.hpp>
+
+/// ----------
+/// Parameters
+
+static const uint32_t Samples       = 1000  ; /*< The amount of samples per latency measurement     */
+static const uint32_t SpawnSamples  = 200   ; /*< The amount of samples per spawn measurement       */
+static const uint32_t Operations    = 100000; /*< The amount of operations per throughput run       */
+static const uint32_t Contenders    = 4     ; /*< The amount of threads contending for one worker   */
+static const uint64_t StackSize     = 256 * 1024;
+static const uint64_t LargeStack    = 8 * 1024 * 1024; /*< The stack size stack options are measured with */
+static const uint64_t TouchedStack  = 4 * 1024 * 1024; /*< How much of it the measurement touches         */
+static const uint32_t ColdWorkers   = 128   ; /*< The amount of workers a cold start brings up    */
+
+/// -------
+/// Samples
+
+/*!
+ * Timestamp written by the code under measurement.
+ */
+
+static Opal::Atomic<Opal::Nanoseconds> Stamp(0);
+
+/*!
+ * Amount of times the code under measurement ran.
+ */
+
+static Opal::Atomic<uint64_t> Count(0);
+
+/*!
+ * Records the time it ran.
+ */
+
+static void Mark(void) { Stamp.store(Opal::Now(), std::memory_order_release); }
+
+/*!
+ * Counts that it ran.
+ */
+
+static void Tally(void) { Count.fetch_add(1, std::memory_order_relaxed); }
+
+/*!
+ * Prints the percentiles of the given samples.
+ * \param name The name of the measurement
+ * \param samples The samples in nanoseconds
+ */
+
+static void Report(const char* name, std::vector<Opal::Nanoseconds>& samples) {
+
+    if(samples.empty()) { printf("%-40s no samples\n", name); return; }
+
+    std::sort(samples.begin(), samples.end());
+
+    auto Percentile = [&](double percentile) {
+
+        return static_cast<unsigned long long>(samples[static_cast<size_t>(percentile * (samples.size() - 1))]);
+
+    };
+
+    printf("%-40s p50 %9llu  p90 %9llu  p99 %9llu  p99.9 %9llu  max %9llu ns\n",
+           name, Percentile(0.5), Percentile(0.9), Percentile(0.99), Percentile(0.999),
+           static_cast<unsigned long long>(samples.back()));
+
+    fflush(stdout);
+
+}
+
+/*!
+ * Prints the throughput of a run.
+ * \param name The name of the measurement
+ * \param operations The amount of operations
+ * \param elapsed The time the operations took
+ */
+
+static void Report(const char* name, uint64_t operations, Opal::Nanoseconds elapsed) {
+
+    printf("%-40s %12.0f ops/s  %9.1f ns/op\n", name,
+           operations * 1e9 / elapsed, static_cast<double>(elapsed) / operations);
+
+    fflush(stdout);
+
+}
+
+/// ---------
+/// Baselines
+
+/*!
+ * Condition variable thread pool; the conventional way of handing
+ * work to a fixed set of threads.
+ */
+
+class ConditionPool {
+
+    Opal::Mutex                         mutex       ;
+    std::condition_variable             condition   ;
+    std::deque<void (*)(void)>          tasks       ;
+    std::vector<std::thread>            threads     ;
+    Opal::Flag                          stopping    ;
+
+public:
+
+    ConditionPool(uint32_t size): mutex(), condition(), tasks(), threads(), stopping(false) {
+
+        for(uint32_t index = 0; index < size; index++) threads.emplace_back([this] {
+
+            while(true) {
+
+                void (*task)(void) = 0;
+
+                {
+
+                    std::unique_lock<Opal::Mutex> lock(mutex);
+
+                    condition.wait(lock, [this] { return stopping || !tasks.empty(); });
+
+                    if(tasks.empty()) return;
+
+                    task = tasks.front();
+
+                    tasks.pop_front();
+
+                }
+
+                task();
+
+            }
+
+        });
+
+    }
+
+    ~ConditionPool() {
+
+        { Opal::Lock<Opal::Mutex> lock(mutex); stopping = true; }
+
+        condition.notify_all();
+
+        for(auto& thread: threads) thread.join();
+
+    }
+
+    void submit(void (*task)(void)) {
+
+        { Opal::Lock<Opal::Mutex> lock(mutex); tasks.push_back(task); }
+
+        condition.notify_one();
+
+    }
+
+};
+
+/*!
+ * Observer that records when its' Opal::Saboteur starts.
+ */
+
+class StampObserver : public Opal::SaboteurObserver {
+
+public:
+
+    void OnStarted(void*) { Stamp.store(Opal::Now(), std::memory_order_release); }
+
+};
+
+/*!
+ * Observer that records when its' Opal::Saboteur is created. The
+ * assembly Lifecycle thread notifies nothing else.
+ */
+
+class CreatedObserver : public Opal::SaboteurObserver {
+
+public:
+
+    void OnCreated(void*) { Stamp.store(Opal::Now(), std::memory_order_release); }
+
+};
+
+/*!
+ * Observer that counts every callback.
+ */
+
+class CountObserver : public Opal::SaboteurObserver {
+
+public:
+
+    Opal::Atomic<uint64_t> callbacks;
+
+    CountObserver(): callbacks(0) { /* Empty */ }
+
+    void OnWaiting(void*) { callbacks.fetch_add(1, std::memory_order_relaxed); }
+    void OnStarted(void*) { callbacks.fetch_add(1, std::memory_order_relaxed); }
+
+};
+
+/// ------------
+/// Measurements
+
+/*!
+ * Time from the spawn call until the spawned thread runs its' first
+ * instruction of user code; for the assembly Lifecycle path, until
+ * it notifies OnCreated.
+ */
+
+static void Spawn() {
+
+    std::vector<Opal::Nanoseconds> samples;
+    CreatedObserver                observer;
+
+    for(uint32_t sample = 0; sample < SpawnSamples; sample++) {
+
+        Stamp.store(0);
+
+        Opal::Nanoseconds start  = Opal::Now();
+        Opal::Saboteur*   thread = new Opal::Saboteur(reinterpret_cast<void*>(Mark), static_cast<Opal::SaboteurObserver*>(0), StackSize);
+
+        while(!Stamp.load(std::memory_order_acquire)) Pause;
+
+        samples.push_back(Stamp.load() - start);
+
+        delete thread;
+
+    }
+
+    Report("spawn: Saboteur (Create)", samples);
+
+    samples.clear();
+
+    for(uint32_t sample = 0; sample < SpawnSamples; sample++) {
+
+        Stamp.store(0);
+
+        Opal::Nanoseconds start  = Opal::Now();
+        Opal::Saboteur*   thread = new Opal::Saboteur(static_cast<Opal::SaboteurObserver*>(&observer), StackSize);
+
+        while(!Stamp.load(std::memory_order_acquire)) Pause;
+
+        samples.push_back(Stamp.load() - start);
+
+        delete thread;
+
+    }
+
+    Report("spawn: Saboteur (Lifecycle)", samples);
+
+    samples.clear();
+
+    for(uint32_t sample = 0; sample < SpawnSamples; sample++) {
+
+        Stamp.store(0);
+
+        Opal::Nanoseconds start = Opal::Now();
+        std::thread       thread(Mark);
+
+        while(!Stamp.load(std::memory_order_acquire)) Pause;
+
+        samples.push_back(Stamp.load() - start);
+
+        thread.join();
+
+    }
+
+    Report("spawn: std::thread", samples);
+
+}
+
+/*!
+ * Time from creating the first of a pool's worth of Saboteurs until
+ * every one of them is waiting; one at a time, and as one batch.
+ */
+
+static void ColdStart() {
+
+    Opal::Saboteur* group[ColdWorkers];
+
+    auto Start = [&](const char* name, Opal::Flag batch) {
+
+        Opal::Nanoseconds start = Opal::Now();
+
+        if(batch) Opal::Saboteur::Spawn(group, ColdWorkers, 0, StackSize);
+
+        else for(uint32_t index = 0; index < ColdWorkers; index++)
+            group[index] = new Opal::Saboteur(static_cast<void*>(0), static_cast<Opal::SaboteurObserver*>(0), StackSize);
+
+        for(uint32_t index = 0; index < ColdWorkers; index++) while(!group[index]->isWaiting()) Yield;
+
+        Report(name, ColdWorkers, Opal::Now() - start);
+
+        for(uint32_t index = 0; index < ColdWorkers; index++) delete group[index];
+
+    };
+
+    Start("cold start: Saboteur (Create)", false);
+    Start("cold start: Saboteur (Spawn)", true);
+
+}
+
+/*!
+ * Time from handing an execution address to an idle worker until
+ * the worker starts on it.
+ */
+
+static void PushToStarted() {
+
+    std::vector<Opal::Nanoseconds> samples;
+
+    {
+
+        StampObserver  observer;
+        Opal::Saboteur thread(static_cast<void*>(0), &observer, StackSize);
+
+        for(uint32_t sample = 0; sample < Samples; sample++) {
+
+            while(!thread.isWaiting()) Pause;
+
+            Stamp.store(0);
+
+            Opal::Nanoseconds start = Opal::Now();
+
+            thread.place(reinterpret_cast<void*>(Tally));
+
+            while(!Stamp.load(std::memory_order_acquire)) Pause;
+
+            samples.push_back(Stamp.load() - start);
+
+        }
+
+    }
+
+    Report("push to OnStarted: Saboteur", samples);
+
+    samples.clear();
+
+    {
+
+        ConditionPool pool(1);
+
+        for(uint32_t sample = 0; sample < Samples; sample++) {
+
+            Stamp.store(0);
+
+            Opal::Nanoseconds start = Opal::Now();
+
+            pool.submit(Mark);
+
+            while(!Stamp.load(std::memory_order_acquire)) Pause;
+
+            samples.push_back(Stamp.load() - start);
+
+        }
+
+    }
+
+    Report("push to start: condition pool", samples);
+
+}
+
+/*!
+ * Time to stop a running Opal::Saboteur, confirm the stop, and
+ * continue it again.
+ */
+
+static void SuspendResume() {
+
+    std::vector<Opal::Nanoseconds> samples;
+
+    Opal::Saboteur  thread(static_cast<void*>(0), static_cast<Opal::SaboteurObserver*>(0), StackSize);
+    Opal::Saboteur* group[] = { &thread };
+
+    while(!thread.isWaiting()) Pause;
+
+    for(uint32_t sample = 0; sample < Samples; sample++) {
+
+        Opal::Nanoseconds start = Opal::Now();
+
+        Opal::Saboteur::SuspendAll(group, 1);
+        Opal::Saboteur::ResumeAll(group, 1);
+
+        samples.push_back(Opal::Now() - start);
+
+    }
+
+    Report("suspend/resume round trip: Saboteur", samples);
+
+}
+
+/*!
+ * Empty execution addresses handed to a single worker by several
+ * threads at once. Every one of them takes the worker through its'
+ * STARTED and WAITING transitions.
+ * \param observer The observer the worker reports to, if any
+ * \param name The name of the measurement
+ */
+
+static void Transitions(Opal::SaboteurObserver* observer, const char* name) {
+
+    Opal::Saboteur            thread(static_cast<void*>(0), observer, StackSize);
+    std::vector<std::thread>  contenders;
+
+    Count.store(0);
+
+    Opal::Nanoseconds start = Opal::Now();
+
+    for(uint32_t index = 0; index < Contenders; index++) contenders.emplace_back([&] {
+
+        for(uint32_t operation = 0; operation < Operations / Contenders; operation++)
+            while(!thread.place(reinterpret_cast<void*>(Tally))) Yield;
+
+    });
+
+    for(auto& contender: contenders) contender.join();
+
+    while(Count.load(std::memory_order_relaxed) < Operations) Yield;
+
+    Report(name, Operations, Opal::Now() - start);
+
+}
+
+/*!
+ * The same work through the condition variable pool.
+ */
+
+static void ConditionTransitions() {
+
+    std::vector<std::thread> contenders;
+
+    Count.store(0);
+
+    Opal::Nanoseconds start = Opal::Now();
+
+    {
+
+        ConditionPool pool(1);
+
+        for(uint32_t index = 0; index < Contenders; index++) contenders.emplace_back([&] {
+
+            for(uint32_t operation = 0; operation < Operations / Contenders; operation++)
+                pool.submit(Tally);
+
+        });
+
+        for(auto& contender: contenders) contender.join();
+
+        while(Count.load(std::memory_order_relaxed) < Operations) Yield;
+
+    }
+
+    Report("contended dispatch: condition pool", Operations, Opal::Now() - start);
+
+}
+
+/*!
+ * The cost of the observer callbacks on the dispatch path.
+ */
+
+static void ObserverDispatch() {
+
+    CountObserver observer;
+
+    Transitions(0, "contended dispatch: Saboteur");
+    Transitions(&observer, "contended dispatch: Saboteur + observer");
+
+    std::vector<Opal::Nanoseconds> samples;
+
+    Opal::SaboteurObserver* dispatch = &observer;
+
+    // The callback on its' own, batched so the clock isn't the measurement
+    for(uint32_t sample = 0; sample < Samples; sample++) {
+
+        Opal::Nanoseconds start = Opal::Now();
+
+        for(uint32_t call = 0; call < 100; call++) dispatch->OnStarted(&observer);
+
+        samples.push_back((Opal::Now() - start) / 100);
+
+    }
+
+    Report("observer dispatch (per callback)", samples);
+
+}
+
+/*!
+ * Green tasks on a single worker; spawning ones that finish right
+ * away, and two of them handing the worker back and forth.
+ */
+
+static void GreenTasks() {
+
+    Opal::Saboteur thread(static_cast<void*>(0), static_cast<Opal::SaboteurObserver*>(0), StackSize);
+
+    Count.store(0);
+
+    Opal::Nanoseconds start = Opal::Now();
+
+    for(uint32_t operation = 0; operation < Operations; operation++) thread.spawn(Tally);
+
+    while(Count.load(std::memory_order_relaxed) < Operations) Yield;
+
+    Report("green spawn to finish: Saboteur", Operations, Opal::Now() - start);
+
+    Count.store(0);
+
+    start = Opal::Now();
+
+    for(uint32_t task = 0; task < 2; task++) thread.spawn([] {
+
+        for(uint32_t operation = 0; operation < Operations; operation++) Opal::GreenTask::Relinquish();
+
+        Tally();
+
+    });
+
+    while(Count.load(std::memory_order_relaxed) < 2) Yield;
+
+    Report("green switch: Saboteur", 2 * Operations, Opal::Now() - start);
+
+}
+
+/*!
+ * The worker the spinning green task last saw itself on.
+ */
+
+static Opal::Atomic<Opal::Saboteur*> Owner(0);
+
+/*!
+ * A green task that never switches out on its' own, moved back and
+ * forth between two workers while it runs. Measured from stopping
+ * the worker it's on until it's seen running on the other one, and
+ * by the workers themselves until it's continued; with fewer cpus
+ * than spinning threads, the first is mostly the scheduler's.
+ */
+
+static void Migration() {
+
+    std::vector<Opal::Nanoseconds> samples;
+
+    Opal::Saboteur  first(static_cast<void*>(0), static_cast<Opal::SaboteurObserver*>(0), StackSize);
+    Opal::Saboteur  second(static_cast<void*>(0), static_cast<Opal::SaboteurObserver*>(0), StackSize);
+    Opal::Saboteur* workers[] = { &first, &second };
+
+    while(!first.isWaiting() || !second.isWaiting()) Pause;
+
+    first.setHistograms();
+    second.setHistograms();
+
+    Count.store(0);
+
+    first.spawn([] {
+
+        while(!Count.load(std::memory_order_relaxed)) Owner.store(Opal::GreenTask::Current()->getOwner(), std::memory_order_relaxed);
+
+    });
+
+    while(Owner.load() != &first) Yield;
+
+    for(uint32_t sample = 0, on = 0; sample < SpawnSamples; sample++, on ^= 1) {
+
+        Opal::Nanoseconds start = Opal::Now();
+
+        if(!workers[on]->migrate(workers[on ^ 1])) break;
+
+        while(Owner.load(std::memory_order_relaxed) != workers[on ^ 1]) Yield;
+
+        samples.push_back(Opal::Now() - start);
+
+    }
+
+    Tally();
+
+    Report("green migrate to running: Saboteur", samples);
+
+    Opal::Histogram pauses;
+
+    Opal::Saboteur::MergeHistograms(workers, 2, HISTOGRAM_MIGRATE, pauses);
+
+    printf("%-40s p50 %9llu  p90 %9llu  p99 %9llu  p99.9 %9llu  max %9llu ns\n", "green migrate to continued: Saboteur",
+           static_cast<unsigned long long>(pauses.getPercentile(50.0)), static_cast<unsigned long long>(pauses.getPercentile(90.0)),
+           static_cast<unsigned long long>(pauses.getPercentile(99.0)), static_cast<unsigned long long>(pauses.getPercentile(99.9)),
+           static_cast<unsigned long long>(pauses.getMaximum()));
+
+}
+
+/*!
+ * Recurses until the given amount of stack is touched.
+ * \param remaining The amount of stack left to touch in bytes
+ */
+
+static void Touch(uint64_t remaining) {
+
+    volatile uint8_t frame[4096];
+
+    frame[0] = 0;
+
+    if(remaining > sizeof(frame)) Touch(remaining - sizeof(frame));
+
+    frame[sizeof(frame) - 1] = frame[0];
+
+}
+
+/*!
+ * Returns the resident size of the process in bytes. Every
+ * Opal::Saboteur shares it.
+ * \return the resident size in bytes
+ */
+
+static uint64_t Resident() {
+
+    unsigned long long pages = 0, resident = 0;
+
+    FILE* file = fopen("/proc/self/statm", "r");
+
+    if(!file) return 0;
+
+    if(fscanf(file, "%llu %llu", &pages, &resident) != 2) resident = 0;
+
+    fclose(file);
+
+    return resident * sysconf(_SC_PAGESIZE);
+
+}
+
+/*!
+ * Page faults the calling thread has taken.
+ */
+
+static Opal::Atomic<uint64_t> Faults(0);
+
+/*!
+ * Touches the stack deep on the worker, recording the page faults
+ * it took and when it finished.
+ */
+
+static void TouchStack(void) {
+
+    struct rusage before, after;
+
+    getrusage(RUSAGE_THREAD, &before);
+
+    Touch(TouchedStack);
+
+    getrusage(RUSAGE_THREAD, &after);
+
+    Faults.store(after.ru_minflt - before.ru_minflt + after.ru_majflt - before.ru_majflt);
+
+    Mark();
+
+}
+
+/*!
+ * What each stack option costs up front in memory and saves later
+ * in page faults, for a worker that touches half of a large stack.
+ */
+
+static void StackOptions() {
+
+    static const struct { uint32_t options; const char* name; } Options[] = {
+
+        { 0,                             "stack: default"             },
+        { STACK_NORESERVE,               "stack: noreserve"           },
+        { STACK_HUGE,                    "stack: huge"                },
+        { STACK_PREFAULT,                "stack: prefault"            },
+        { STACK_HUGE | STACK_PREFAULT,   "stack: huge prefault"       }
+
+    };
+
+    for(const auto& option: Options) {
+
+        uint64_t resident = Resident();
+
+        Opal::Saboteur thread(static_cast<void*>(0), static_cast<Opal::SaboteurObserver*>(0), LargeStack,
+                              Opal::Placement().setStackOptions(option.options));
+
+        while(!thread.isWaiting()) Pause;
+
+        uint64_t created = Resident();
+
+        Stamp.store(0);
+
+        Opal::Nanoseconds start = Opal::Now();
+
+        thread.place(reinterpret_cast<void*>(TouchStack));
+
+        while(!Stamp.load(std::memory_order_acquire)) Pause;
+
+        Opal::Nanoseconds elapsed = Stamp.load() - start;
+
+        printf("%-40s rss +%7llu KiB created  +%7llu KiB touched  %6llu faults  %9llu ns\n", option.name,
+               static_cast<unsigned long long>((created - resident) / 1024),
+               static_cast<unsigned long long>((Resident() - resident) / 1024),
+               static_cast<unsigned long long>(Faults.load()), static_cast<unsigned long long>(elapsed));
+
+        fflush(stdout);
+
+    }
+
+}
+
+/*!
+ * Time from terminating a pool's worth of Saboteurs until a single
+ * Opal::Supervisor has collected every exit, and the wakes it took.
+ */
+
+static void Supervision() {
+
+    Opal::Supervisor        supervisor(ColdWorkers);
+    Opal::Saboteur*         group[ColdWorkers];
+    Opal::Supervisor::Event events[ColdWorkers];
+
+    Opal::Saboteur::Spawn(group, ColdWorkers, 0, StackSize);
+
+    for(uint32_t index = 0; index < ColdWorkers; index++) {
+
+        while(!group[index]->isWaiting()) Yield;
+
+        supervisor.watch(group[index]);
+
+    }
+
+    uint32_t                exited  = 0;
+    uint32_t                wakes   = 0;
+    Opal::Nanoseconds       start   = Opal::Now();
+
+    for(uint32_t index = 0; index < ColdWorkers; index++) group[index]->terminate();
+
+    for(; exited < ColdWorkers; wakes++) {
+
+        uint32_t count = supervisor.wait(events, ColdWorkers);
+
+        // Only exits count; a stray stop isn't what we're timing
+        for(uint32_t index = 0; index < count; index++)
+            if(events[index].kind == SUPERVISOR_EXITED) exited++;
+
+    }
+
+    Report("supervise: exits (epoll)", ColdWorkers, Opal::Now() - start);
+
+    printf("%-40s %u wakes for %u exits\n", "supervise: wakes", wakes, exited);
+
+    fflush(stdout);
+
+    for(uint32_t index = 0; index < ColdWorkers; index++) delete group[index];
+
+}
+
+/// ----
+/// Main
+
+int main() {
+
+    Spawn();
+    ColdStart();
+    PushToStarted();
+    SuspendResume();
+    ObserverDispatch();
+    ConditionTransitions();
+    GreenTasks();
+    Migration();
+    StackOptions();
+    Supervision();
+
+    return 0;
+
+}
@@ -19,5 +19,11 @@ namespace Opal { /* Empty */ }
 #include<Types.hpp>
 #include<SaboteurObserver.hpp>
 #include<Saboteur.hpp>
+#include<SaboteurPool.hpp>
+#include<GreenTask.hpp>
+#include<Counters.hpp>
+#include<Histogram.hpp>
+#include<Supervisor.hpp>
+#include<StaticSaboteur.hpp>
 
 #endif
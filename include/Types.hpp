@@ -13,7 +13,9 @@
 /// --------
 /// Includes
 
+#include<atomic>
 #include<cinttypes>
+#include<ctime>
 #include<exception>
 #include<mutex>
 
@@ -37,6 +39,34 @@ namespace Opal {
 
     #define Yield sched_yield()
 
+    /*!
+     * \def #define Pause __asm__ __volatile__("pause")
+     * \brief Macro Definition for a spin-wait hint.
+     * Platform-dependant, Linux x86-64.
+     */
+
+    #define Pause __asm__ __volatile__("pause")
+
+    /*!
+     * \def #define FutexWait(address, expected)
+     * \brief Macro Definition for a futex wait on a 32-bit word. Sleeps
+     * as long as the word at the address holds the expected value.
+     * Platform-dependant, Linux x86-64.
+     */
+
+    #define FutexWait(address, expected) \
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(address), FUTEX_WAIT_PRIVATE, expected, 0, 0, 0)
+
+    /*!
+     * \def #define FutexWake(address, count)
+     * \brief Macro Definition for a futex wake on a 32-bit word. Wakes
+     * at most count waiters sleeping on the address.
+     * Platform-dependant, Linux x86-64.
+     */
+
+    #define FutexWake(address, count) \
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(address), FUTEX_WAKE_PRIVATE, count, 0, 0, 0)
+
     /*!
      * \def Macro definition to stop a process
      * \brief Tested with linux arm64
@@ -117,6 +147,20 @@ namespace Opal {
 
     typedef uint64_t State;
 
+    /*!
+     * \var typedef uint32_t EventMask;
+     * \brief Type definition for a set of observer events
+     */
+
+    typedef uint32_t EventMask;
+
+    /*!
+     * \var typedef uint64_t Nanoseconds;
+     * \brief Type definition for a duration or timestamp in nanoseconds
+     */
+
+    typedef uint64_t Nanoseconds;
+
     /*!
      * \var typedef bool Flag;
      * \brief Type definition for a flag
@@ -153,6 +197,32 @@ namespace Opal {
     template<typename Type>
     using Lock = std::lock_guard<Type>;
 
+    /*!
+     * \var template<typename Type> using Atomic<Type> = std::atomic<Type>
+     * \brief Alias for an atomic value.
+     */
+
+    template<typename Type>
+    using Atomic = std::atomic<Type>;
+
+    /// ---------
+    /// Functions
+
+    /*!
+     * Returns the current value of the monotonic clock.
+     * \return Opal::Nanoseconds since an unspecified starting point.
+     */
+
+    inline Opal::Nanoseconds Now() {
+
+        timespec time;
+
+        clock_gettime(CLOCK_MONOTONIC, &time);
+
+        return static_cast<Opal::Nanoseconds>(time.tv_sec) * 1000000000 + time.tv_nsec;
+
+    }
+
 }
 
 #endif
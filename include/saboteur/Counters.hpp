@@ -0,0 +1,228 @@
+/*!
+ * \brief Counters class
+ *
+ * Opal::Counters declaration. A perf_event group attached to a single
+ * thread, counting its' cycles, instructions, last level cache misses,
+ * context switches and page faults in user space. The thread being
+ * counted reads its' own hardware counters with rdpmc when the kernel
+ * allows it, and the whole group with a single read() otherwise.
+ *
+ * The counted thread attributes what each execution address it runs
+ * costs to where the address came from, so the cost of a function,
+ * a kind of Opal::Task or a coroutine adds up across every run of it.
+ * Attributions live in a fixed table; sources that don't fit are
+ * added up together.
+ *
+ * \author Carlos L. Cuenca
+ * \version 0.1.0
+ * \date 02/07/2022
+ */
+
+#ifndef OPAL_COUNTERS_HPP
+#define OPAL_COUNTERS_HPP
+
+/// --------
+/// Includes
+
+#include<linux/perf_event.h>
+#include<sys/types.h>
+#include<Types.hpp>
+
+namespace Opal { class Counters; }
+
+/// -----------------
+/// Class Declaration
+
+class Opal::Counters {
+
+    /// --------------
+    /// Public Members
+
+public:
+
+    /*!
+     * The amount of events in the group.
+     */
+
+    static const uint32_t Events = 5;
+
+    /*!
+     * The amount of sources the Opal::Counters attribute to
+     * separately. Must be a power of two.
+     */
+
+    static const uint32_t Capacity = 256;
+
+    /*!
+     * The value of every counter at some point, or what they
+     * counted in between two points.
+     */
+
+    struct Sample {
+
+        uint64_t    cycles          ; /*< Cycles spent in user space            */
+        uint64_t    instructions    ; /*< Instructions retired in user space    */
+        uint64_t    cacheMisses     ; /*< Last level cache misses               */
+        uint64_t    contextSwitches ; /*< Context switches                      */
+        uint64_t    pageFaults      ; /*< Page faults                           */
+
+    };
+
+    /*!
+     * What the runs of a single source added up to.
+     */
+
+    struct Attribution {
+
+        void*       source  ; /*< Where the execution addresses came from, null for the rest */
+        uint64_t    runs    ; /*< The amount of runs                                            */
+        Sample      total   ; /*< What the runs counted                                         */
+
+    };
+
+    /// ---------------
+    /// Private Members
+
+private:
+
+    /*!
+     * A source and what its' runs added up to. Only the counted
+     * thread writes; anyone may read.
+     */
+
+    struct Slot {
+
+        Opal::Atomic<void*>     source          ; /*< The source, null while unclaimed   */
+        Opal::Atomic<uint64_t>  runs            ; /*< The amount of runs                 */
+        Opal::Atomic<uint64_t>  total[Events]   ; /*< What the runs counted              */
+
+    };
+
+    /// ----------------
+    /// Member Variables
+
+    int32_t                         descriptors[Events] ; /*< The event descriptors, negative if unavailable        */
+    uint32_t                        positions[Events]   ; /*< Where each event is in a group read                   */
+    perf_event_mmap_page*           pages[Events]       ; /*< The mapped pages of the hardware events, if any       */
+    uint32_t                        members             ; /*< The amount of events in the group                     */
+    Opal::Flag                      direct              ; /*< Denotes if every member can be read with rdpmc        */
+    Slot                            slots[Capacity]     ; /*< The attributions by source                            */
+    Slot                            rest                ; /*< The sources that didn't fit                           */
+
+    /// -------
+    /// Methods
+
+    /*!
+     * Reads the given hardware event with rdpmc. Must be invoked by
+     * the counted thread.
+     * \param event The event
+     * \param value Where the value goes
+     * \return Opal::Flag denoting if the event could be read directly
+     */
+
+    Opal::Flag readDirect(uint32_t, uint64_t&);
+
+    /*!
+     * Returns the slot of the given source, claiming one if it has
+     * none yet. Must be invoked by the counted thread.
+     * \param source The source
+     * \return Reference to the slot
+     */
+
+    Slot& slotOf(void*);
+
+    /// --------------
+    /// Public Members
+
+public:
+
+    /// ------------
+    /// Constructors
+
+    /*!
+     * Default Constructor. Initializes closed Opal::Counters.
+     */
+
+    Counters();
+
+    /*!
+     * Deconstructor. Closes the group.
+     */
+
+    ~Counters();
+
+    /*!
+     * The descriptors belong to a single group.
+     */
+
+    Counters(const Counters&)            = delete;
+    Counters& operator=(const Counters&) = delete;
+
+    /// -------
+    /// Methods
+
+    /*!
+     * Opens the group on the given thread. Events the processor or
+     * the kernel doesn't provide are left out and read as zero. A
+     * group without the software events can be read with rdpmc alone.
+     * \param threadID The thread to count
+     * \param software Denotes if context switches and page faults are counted
+     * \return Opal::Flag denoting if any event could be opened
+     */
+
+    Opal::Flag open(pid_t, Opal::Flag=true);
+
+    /*!
+     * Closes the group.
+     */
+
+    void close();
+
+    /*!
+     * Returns a flag denoting if any event is counting.
+     * \return Opal::Flag denoting if the group is open
+     */
+
+    Opal::Flag isOpen() const;
+
+    /*!
+     * Reads every counter with a single read(). Any thread may read.
+     * \param sample Where the values go
+     * \return Opal::Flag denoting if the group could be read
+     */
+
+    Opal::Flag read(Sample&);
+
+    /*!
+     * Reads every counter from the counted thread itself; with rdpmc
+     * alone if every event allows it, with read() otherwise.
+     * \param sample Where the values go
+     * \return Opal::Flag denoting if the group could be read
+     */
+
+    Opal::Flag readSelf(Sample&);
+
+    /*!
+     * Adds what was counted in between the given samples to the given
+     * source. Must be invoked by the counted thread.
+     * \param source Where the run came from
+     * \param before The sample taken before the run
+     * \param after The sample taken after the run
+     */
+
+    void attribute(void*, const Sample&, const Sample&);
+
+    /*!
+     * Copies the attributions into the given array, in no particular
+     * order. The sources that didn't fit come last, with a null
+     * source, if there are any. Any thread may invoke.
+     * \param attributions The array to fill
+     * \param capacity The capacity of the array
+     * \return the amount of attributions written
+     */
+
+    uint32_t getAttributions(Attribution*, uint32_t);
+
+};
+
+#endif
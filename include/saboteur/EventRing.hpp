@@ -0,0 +1,126 @@
+/*!
+ * \brief EventRing class
+ *
+ * Opal::EventRing declaration. A bounded ring of the state transitions
+ * of an Opal::Saboteur, waiting to be delivered to its' observer. Any
+ * thread that transitions the Opal::Saboteur may append without
+ * acquiring a lock; a single observer thread drains. A transition that
+ * finds the ring full is dropped and counted rather than blocking the
+ * thread that caused it.
+ *
+ * \author Carlos L. Cuenca
+ * \version 0.1.0
+ * \date 02/07/2022
+ */
+
+#ifndef OPAL_EVENT_RING_HPP
+#define OPAL_EVENT_RING_HPP
+
+/// --------
+/// Includes
+
+#include<Types.hpp>
+
+namespace Opal { class EventRing; }
+
+/// -----------------
+/// Class Declaration
+
+class Opal::EventRing {
+
+    /// --------------
+    /// Public Members
+
+public:
+
+    /*!
+     * The amount of transitions the Opal::EventRing holds.
+     * Must be a power of two.
+     */
+
+    static const uint64_t Capacity = 1024;
+
+    /// ---------------
+    /// Private Members
+
+private:
+
+    /*!
+     * A recorded transition. The sequence denotes if the
+     * cell is ready to be written or ready to be read.
+     */
+
+    struct Cell {
+
+        Opal::Atomic<uint64_t>  sequence    ;
+        Opal::State             state       ;
+
+    };
+
+    /// ----------------
+    /// Member Variables
+
+    Cell                    cells[Capacity]     ; /*< The recorded transitions                      */
+    Opal::Atomic<uint64_t>  recordIndex         ; /*< The position of the next record               */
+    uint64_t                drainIndex          ; /*< The position of the next drain; drainer only  */
+    Opal::Atomic<uint64_t>  dropped             ; /*< The amount of transitions that didn't fit     */
+    Opal::Atomic<uint64_t>  coalesced           ; /*< The amount of transitions left undelivered    */
+
+    /// --------------
+    /// Public Members
+
+public:
+
+    /// ------------
+    /// Constructors
+
+    /*!
+     * Default Constructor. Initializes an empty Opal::EventRing.
+     */
+
+    EventRing();
+
+    /// -------
+    /// Methods
+
+    /*!
+     * Appends the given transition. Any number of threads may record
+     * at once.
+     * \param state The Opal::State transitioned to
+     * \return Opal::Flag denoting if the transition was recorded; false
+     * if the Opal::EventRing is full and it was dropped.
+     */
+
+    Opal::Flag record(Opal::State);
+
+    /*!
+     * Removes up to the given amount of the oldest transitions and
+     * copies them into the given buffer. A WAITING transition directly
+     * followed by a STARTED one is removed along with it; the observer
+     * would only hear that the Opal::Saboteur went idle and immediately
+     * picked something up again. Only one thread may drain.
+     * \param states The buffer to copy into
+     * \param count The capacity of the buffer
+     * \return the amount of transitions copied
+     */
+
+    uint64_t drain(Opal::State*, uint64_t);
+
+    /*!
+     * Returns the amount of transitions that were dropped because
+     * the Opal::EventRing was full.
+     * \return the amount of dropped transitions
+     */
+
+    uint64_t getDropped();
+
+    /*!
+     * Returns the amount of transitions that were coalesced away.
+     * \return the amount of coalesced transitions
+     */
+
+    uint64_t getCoalesced();
+
+};
+
+#endif
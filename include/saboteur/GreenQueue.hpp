@@ -0,0 +1,107 @@
+/*!
+ * \brief GreenQueue class
+ *
+ * Opal::GreenQueue declaration. The run queue of the green tasks
+ * multiplexed on an Opal::Saboteur. The queue is intrusive; every
+ * green task carries its' own link, so it holds any amount of them
+ * without allocating. Any thread may push without acquiring a lock;
+ * only the Opal::Saboteur that owns the queue pops.
+ *
+ * \author Carlos L. Cuenca
+ * \version 0.1.0
+ * \date 02/07/2022
+ */
+
+#ifndef OPAL_GREEN_QUEUE_HPP
+#define OPAL_GREEN_QUEUE_HPP
+
+/// --------
+/// Includes
+
+#include<Types.hpp>
+
+namespace Opal { class GreenQueue; }
+
+/// -----------------
+/// Class Declaration
+
+class Opal::GreenQueue {
+
+    /// --------------
+    /// Public Members
+
+public:
+
+    /*!
+     * The link every queued item starts with.
+     */
+
+    struct Link {
+
+        Opal::Atomic<Link*>     next    ;
+
+    };
+
+    /// ---------------
+    /// Private Members
+
+private:
+
+    /// ----------------
+    /// Member Variables
+
+    Opal::Atomic<Link*>     head        ; /*< The most recently pushed link                 */
+    Link*                   tail        ; /*< The next link to pop, owned by the consumer   */
+    Link                    stub        ; /*< Keeps the queue from ever being truly empty   */
+
+    /// --------------
+    /// Public Members
+
+public:
+
+    /// ------------
+    /// Constructors
+
+    /*!
+     * Default Constructor. Initializes an empty Opal::GreenQueue.
+     */
+
+    GreenQueue();
+
+    /*!
+     * The links point at the stub inside the Opal::GreenQueue.
+     */
+
+    GreenQueue(const GreenQueue&)            = delete;
+    GreenQueue& operator=(const GreenQueue&) = delete;
+
+    /// -------
+    /// Methods
+
+    /*!
+     * Pushes the given link to the back of the Opal::GreenQueue.
+     * Any thread may push.
+     * \param link The link to push
+     */
+
+    void push(Link*);
+
+    /*!
+     * Removes and returns the link at the front. Consumer only.
+     * \return the link, or null if there is none or a push hasn't
+     * finished linking yet.
+     */
+
+    Link* pop();
+
+    /*!
+     * Returns a flag denoting if the Opal::GreenQueue holds nothing,
+     * not even a push in progress. Consumer only.
+     * \return Opal::Flag denoting if the Opal::GreenQueue is empty
+     */
+
+    Opal::Flag isEmpty();
+
+};
+
+#endif
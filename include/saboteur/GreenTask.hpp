@@ -0,0 +1,315 @@
+/*!
+ * \brief GreenTask class
+ *
+ * Opal::GreenTask declaration. A stackful task multiplexed on an
+ * Opal::Saboteur; any amount of them take turns on the same kernel
+ * thread, switching in user space. Each Opal::GreenTask lives at the
+ * top of its' own small stack. Stacks are carved from aligned slabs
+ * and pooled, so the running Opal::GreenTask is found from the stack
+ * pointer alone and spawning one is a free list pop.
+ *
+ * Green stacks have no guard pages; a guard per stack would exhaust
+ * the kernel's mapping limit long before the tasks it's meant to
+ * scale to. Overflows are caught instead whenever an Opal::GreenTask
+ * switches out, through the stack pointer it left behind and a canary
+ * the stack above it would run into first.
+ *
+ * \author Carlos L. Cuenca
+ * \version 0.1.0
+ * \date 02/07/2022
+ */
+
+#ifndef OPAL_GREEN_TASK_HPP
+#define OPAL_GREEN_TASK_HPP
+
+/// --------
+/// Includes
+
+#include<sys/mman.h>
+#include<Types.hpp>
+#include<Task.hpp>
+#include<GreenQueue.hpp>
+
+namespace Opal { class GreenTask; class Saboteur; }
+
+/// ---------------
+/// Context Switch
+
+/*!
+ * Saves the callee-saved state of the running context on its' stack,
+ * stores the stack pointer in save, and continues the context saved
+ * at load. Implemented in Switch.asm.
+ * \param save Where the stack pointer of the running context goes
+ * \param load The stack pointer of the context to continue
+ */
+
+extern "C" void SwitchContext(void** save, void* load);
+
+/*!
+ * The first return address of a context that has never run.
+ * Invokes the entry function in r13 with the argument in r12.
+ * Implemented in Switch.asm.
+ */
+
+extern "C" void ContextStart();
+
+/// -----------------
+/// Class Declaration
+
+class Opal::GreenTask : public Opal::GreenQueue::Link {
+
+    /// --------------
+    /// Public Members
+
+public:
+
+    /*!
+     * The size of every green stack in bytes, the Opal::GreenTask
+     * included. Must be a power of two; stacks are aligned to it.
+     */
+
+    static const uint64_t StackSize = 16 * 1024;
+
+    /*!
+     * The amount of green stacks mapped at once.
+     */
+
+    static const uint64_t SlabSize = 64;
+
+    /// ---------------
+    /// Private Members
+
+private:
+
+    /// -----------------------
+    /// Static Member Variables
+
+    static Opal::Atomic<uint64_t> Released  ; /*< The tagged top of the released green stacks */
+    static Opal::Atomic<uint64_t> Mapped    ; /*< The amount of green stacks mapped             */
+
+    /// ----------------
+    /// Member Variables
+
+    void*                   context     ; /*< The stack pointer the task switched out with  */
+    void*                   worker      ; /*< The stack pointer of the worker running it    */
+    Opal::Task              body        ; /*< What the task executes                        */
+    Opal::Saboteur*         owner       ; /*< The Opal::Saboteur the task runs on           */
+    Opal::Atomic<uint32_t>  state       ; /*< Denotes if the task is suspended or woken     */
+    uint32_t                action      ; /*< Why the task switched out                     */
+    Opal::Nanoseconds       migrating   ; /*< When the task was stopped to migrate, if it was */
+    uint64_t                canary      ; /*< Last, so an overflow from above hits it first */
+
+    /// --------------
+    /// Static Methods
+
+    /*!
+     * The first function a green task executes. Runs the body
+     * and switches out for the last time.
+     * \param task The Opal::GreenTask starting up
+     */
+
+    static void Entry(GreenTask*) noexcept;
+
+    /*!
+     * Returns the base of an unused green stack, mapping a slab
+     * if none is left.
+     * \return the lowest address of the stack, or null if the
+     * mapping failed.
+     */
+
+    static uint8_t* Allocate();
+
+    /*!
+     * Returns the given chain of green stacks to the unused ones.
+     * Each stack links to the next one at its' top.
+     * \param first The lowest address of the first stack in the chain
+     * \param last The lowest address of the last stack in the chain
+     */
+
+    static void Release(uint8_t*, uint8_t*);
+
+    /*!
+     * Switches from the running green task back to its' worker,
+     * recording why.
+     * \param task The running Opal::GreenTask
+     * \param action Why the task switches out
+     */
+
+    static void SwitchOut(GreenTask*, uint32_t);
+
+    /// ------------
+    /// Constructors
+
+    /*!
+     * Initializes the Opal::GreenTask at the top of its' stack so
+     * that it starts in Entry() the first time it's resumed.
+     * \param body What the task executes
+     * \param owner The Opal::Saboteur the task runs on
+     */
+
+    GreenTask(Opal::Task&&, Opal::Saboteur*);
+
+    /// --------------
+    /// Public Members
+
+public:
+
+    /*!
+     * A green task is identified by its' address.
+     */
+
+    GreenTask(const GreenTask&)            = delete;
+    GreenTask& operator=(const GreenTask&) = delete;
+
+    /// --------------
+    /// Static Methods
+
+    /*!
+     * Creates an Opal::GreenTask that runs the given body on the
+     * given Opal::Saboteur. The task doesn't run until it's queued.
+     * \param body What the task executes
+     * \param owner The Opal::Saboteur the task runs on
+     * \return Pointer to the Opal::GreenTask
+     * \throws GreenTaskCreateFailureException if no stack could be mapped.
+     */
+
+    static GreenTask* Create(Opal::Task&&, Opal::Saboteur*);
+
+    /*!
+     * Runs the given Opal::GreenTask on the invoking worker until it
+     * switches out. A relinquished task is queued on its' Opal::Saboteur
+     * again, a preempted one behind the ready ones; a finished one is
+     * destroyed and its' stack released.
+     * \param task The Opal::GreenTask to run
+     * \throws GreenStackOverflowException if the task overflowed its' stack.
+     */
+
+    static void Resume(GreenTask*);
+
+    /*!
+     * Returns the Opal::GreenTask running on the invoking thread.
+     * Must be invoked from within a green task.
+     * \return Pointer to the running Opal::GreenTask
+     */
+
+    static GreenTask* Current();
+
+    /*!
+     * Returns the Opal::GreenTask whose stack the given address would
+     * be in, if it's in a green stack at all. Nothing is read.
+     * \param address The address, usually a stack pointer
+     * \return Pointer to the Opal::GreenTask
+     */
+
+    static GreenTask* Of(void*);
+
+    /*!
+     * Lets the other green tasks of the Opal::Saboteur run; the
+     * invoking task continues once its' turn comes around again.
+     * Must be invoked from within a green task.
+     */
+
+    static void Relinquish();
+
+    /*!
+     * Switches the invoking green task out as if its' time slice ran
+     * out; it's queued behind every green task that's ready. The time
+     * slice handler diverts preempted green tasks here.
+     * Must be invoked from within a green task.
+     */
+
+    static void Preempt();
+
+    /*!
+     * Switches the invoking green task out to the Opal::Saboteur it was
+     * handed over to, where it continues. Opal::Saboteur::migrate diverts
+     * the green tasks it moves here.
+     * Must be invoked from within a green task.
+     */
+
+    static void Migrate();
+
+    /*!
+     * Suspends the invoking green task until it's woken. A wake that
+     * arrived since the last suspension is consumed instead.
+     * Must be invoked from within a green task.
+     */
+
+    static void Suspend();
+
+    /*!
+     * Wakes the given Opal::GreenTask. If it isn't suspended yet,
+     * its' next suspension returns immediately. Any thread may wake.
+     * \param task The Opal::GreenTask to wake
+     */
+
+    static void Wake(GreenTask*);
+
+    /*!
+     * Returns the amount of green stacks that have been mapped.
+     * \return the amount of mapped green stacks
+     */
+
+    static uint64_t GetMapped();
+
+    /// -------
+    /// Methods
+
+    /*!
+     * Returns the Opal::Saboteur the Opal::GreenTask runs on.
+     * \return Pointer to the Opal::Saboteur
+     */
+
+    Opal::Saboteur* getOwner();
+
+    /*!
+     * Hands the Opal::GreenTask over to the given Opal::Saboteur. Only
+     * while the worker running it is stopped, with its' next switch out
+     * diverted to Migrate().
+     * \param owner The Opal::Saboteur the task continues on
+     * \param stoppedAt When the worker running it was stopped
+     */
+
+    void handOver(Opal::Saboteur*, Opal::Nanoseconds);
+
+    /*!
+     * Returns what identifies the kind of body the Opal::GreenTask runs.
+     * \return the source of the body
+     */
+
+    void* getSource() const;
+
+    /// ----------
+    /// Exceptions
+
+    /*!
+     * Exception that gets thrown when a green stack can't be mapped.
+     */
+
+    class GreenTaskCreateFailureException : public Opal::Exception {
+
+        Opal::StringLiteral what() const throw() {
+
+            return "Error: Green task creation failed.";
+
+        }
+
+    };
+
+    /*!
+     * Exception that gets thrown when a green task overflowed its' stack.
+     */
+
+    class GreenStackOverflowException : public Opal::Exception {
+
+        Opal::StringLiteral what() const throw() {
+
+            return "Error: Green task stack overflow.";
+
+        }
+
+    };
+
+};
+
+#endif
@@ -0,0 +1,195 @@
+/*!
+ * \brief Histogram class
+ *
+ * Opal::Histogram declaration. A fixed size, log-linear histogram of
+ * nanosecond latencies, in the manner of an HDR histogram; every power
+ * of two range is split into the same amount of linear buckets, so a
+ * recorded value is off by at most 1/SubBuckets of itself, from a
+ * nanosecond up to days. Any number of threads may record at once
+ * without acquiring a lock, and recording never allocates, so an
+ * Opal::Histogram can be left recording in production.
+ *
+ * \author Carlos L. Cuenca
+ * \version 0.1.0
+ * \date 02/07/2022
+ */
+
+#ifndef OPAL_HISTOGRAM_HPP
+#define OPAL_HISTOGRAM_HPP
+
+/// --------
+/// Includes
+
+#include<Types.hpp>
+
+namespace Opal { class Histogram; }
+
+/// -----------------
+/// Class Declaration
+
+class Opal::Histogram {
+
+    /// --------------
+    /// Public Members
+
+public:
+
+    /*!
+     * The amount of linear buckets in every power of two range.
+     * Must be a power of two.
+     */
+
+    static const uint32_t SubBuckets = 32;
+
+    /*!
+     * The amount of power of two ranges above the first; values
+     * past them are recorded in the last bucket.
+     */
+
+    static const uint32_t Ranges = 43;
+
+    /*!
+     * The amount of buckets.
+     */
+
+    static const uint32_t Buckets = (Ranges + 1) * SubBuckets;
+
+    /*!
+     * A bucket that holds recorded values.
+     */
+
+    struct Bucket {
+
+        uint64_t    value   ; /*< The lowest value that falls in the bucket    */
+        uint64_t    count   ; /*< The amount of values recorded in it          */
+
+    };
+
+    /// ---------------
+    /// Private Members
+
+private:
+
+    /// ----------------
+    /// Member Variables
+
+    Opal::Atomic<uint64_t>  counts[Buckets]     ; /*< The amount of values in each bucket   */
+    Opal::Atomic<uint64_t>  count               ; /*< The amount of values recorded         */
+    Opal::Atomic<uint64_t>  sum                 ; /*< The sum of the values recorded        */
+    Opal::Atomic<uint64_t>  minimum             ; /*< The smallest value recorded           */
+    Opal::Atomic<uint64_t>  maximum             ; /*< The largest value recorded            */
+
+    /// --------------
+    /// Public Members
+
+public:
+
+    /// ------------
+    /// Constructors
+
+    /*!
+     * Default Constructor. Initializes an empty Opal::Histogram.
+     */
+
+    Histogram();
+
+    /*!
+     * Recording threads hold on to the Opal::Histogram.
+     */
+
+    Histogram(const Histogram&)            = delete;
+    Histogram& operator=(const Histogram&) = delete;
+
+    /// --------------
+    /// Static Methods
+
+    /*!
+     * Returns the bucket the given value falls in.
+     * \param value The value
+     * \return the index of the bucket
+     */
+
+    static uint32_t IndexOf(uint64_t);
+
+    /*!
+     * Returns the lowest value that falls in the given bucket.
+     * \param index The index of the bucket
+     * \return the lowest value of the bucket
+     */
+
+    static uint64_t ValueOf(uint32_t);
+
+    /// -------
+    /// Methods
+
+    /*!
+     * Records the given value. Any thread may record.
+     * \param value The value in nanoseconds
+     */
+
+    void record(uint64_t);
+
+    /*!
+     * Adds every value recorded in the given Opal::Histogram.
+     * \param histogram The Opal::Histogram to add
+     */
+
+    void merge(const Histogram&);
+
+    /*!
+     * Forgets every recorded value. Values recorded meanwhile
+     * may be partially forgotten.
+     */
+
+    void reset();
+
+    /*!
+     * Returns the value below which the given percentage of the
+     * recorded values fall, as the highest value of its' bucket.
+     * \param percentile The percentile, from 0 to 100
+     * \return the value, or zero if nothing was recorded
+     */
+
+    uint64_t getPercentile(double) const;
+
+    /*!
+     * Copies the buckets that hold values into the given array,
+     * lowest first.
+     * \param buckets The array to fill
+     * \param capacity The capacity of the array
+     * \return the amount of buckets written
+     */
+
+    uint32_t getBuckets(Bucket*, uint32_t) const;
+
+    /*!
+     * Returns the amount of values recorded.
+     * \return the amount of values
+     */
+
+    uint64_t getCount() const;
+
+    /*!
+     * Returns the mean of the values recorded.
+     * \return the mean, or zero if nothing was recorded
+     */
+
+    double getMean() const;
+
+    /*!
+     * Returns the smallest value recorded.
+     * \return the smallest value, or zero if nothing was recorded
+     */
+
+    uint64_t getMinimum() const;
+
+    /*!
+     * Returns the largest value recorded.
+     * \return the largest value
+     */
+
+    uint64_t getMaximum() const;
+
+};
+
+#endif
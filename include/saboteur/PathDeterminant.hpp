@@ -0,0 +1,307 @@
+/*!
+ * \brief PathDeterminant class
+ *
+ * Opal::PathDeterminant declaration. Holds the execution addresses
+ * an Opal::Saboteur has yet to execute. Addresses that are pushed
+ * take the highest priority (the most recent push executes first),
+ * addresses that are placed take the lowest priority (first placed,
+ * first executed). Any number of threads may push, place and take at
+ * once without acquiring a lock.
+ *
+ * Pushed addresses live in a stack of preallocated nodes; placed
+ * addresses live in a bounded ring. Both are indexed, so nothing is
+ * allocated or released once the Opal::PathDeterminant is constructed,
+ * and the stack heads carry a tag that is bumped on every update to
+ * rule out ABA.
+ *
+ * Opal::Tasks live inline in a pushed node. A queued Opal::Task is
+ * represented by a tagged pointer to its' node, so it travels through
+ * the ring and the Opal::StealingDeque like any execution address;
+ * its' node is released once the Opal::Task has run. Suspended
+ * coroutines are queued the same way, as a tagged pointer to their
+ * frame.
+ *
+ * \author Carlos L. Cuenca
+ * \version 0.1.0
+ * \date 02/07/2022
+ */
+
+#ifndef OPAL_PATH_DETERMINANT_HPP
+#define OPAL_PATH_DETERMINANT_HPP
+
+/// --------
+/// Includes
+
+#include<Types.hpp>
+#include<Task.hpp>
+
+#if __cpp_impl_coroutine
+#include<coroutine>
+#endif
+
+namespace Opal { class PathDeterminant; }
+
+/// -----------------
+/// Class Declaration
+
+class Opal::PathDeterminant {
+
+    /// --------------
+    /// Public Members
+
+public:
+
+    /*!
+     * The amount of pushed and the amount of placed execution
+     * addresses the Opal::PathDeterminant holds. Must be a power of two.
+     */
+
+    static const uint32_t Capacity = 256;
+
+    /// ---------------
+    /// Private Members
+
+private:
+
+    /*!
+     * A pushed execution address, or the storage of a queued
+     * Opal::Task. The next member holds the index (plus one) of the
+     * node below it.
+     */
+
+    struct Node {
+
+        Opal::Atomic<uint32_t>      next    ;
+        void*                       address ;
+        Opal::Nanoseconds           queued  ;
+        Opal::Task                  task    ;
+        Opal::PathDeterminant*      owner   ;
+
+    };
+
+    /*!
+     * A placed execution address. The sequence denotes if the
+     * cell is ready to be written or ready to be read.
+     */
+
+    struct Cell {
+
+        Opal::Atomic<uint64_t>  sequence    ;
+        void*                   address     ;
+        Opal::Nanoseconds       queued      ;
+
+    };
+
+    /// ----------------
+    /// Member Variables
+
+    Node                    nodes[Capacity]     ; /*< Storage for the pushed execution addresses    */
+    Opal::Atomic<uint64_t>  pushed              ; /*< Tagged head of the pushed execution addresses */
+    Opal::Atomic<uint64_t>  available           ; /*< Tagged head of the unused nodes               */
+    Cell                    cells[Capacity]     ; /*< Storage for the placed execution addresses    */
+    Opal::Atomic<uint64_t>  placeIndex          ; /*< The position of the next place                */
+    Opal::Atomic<uint64_t>  takeIndex           ; /*< The position of the next take                 */
+    Opal::Atomic<Opal::Flag> stamping            ; /*< Denotes if addresses are stamped when queued  */
+
+    /// -------
+    /// Methods
+
+    /*!
+     * Pops the node at the top of the given tagged stack.
+     * \param stack The tagged head of the stack
+     * \return the index of the node plus one, or zero if the stack is empty
+     */
+
+    uint32_t popFrom(Opal::Atomic<uint64_t>&);
+
+    /*!
+     * Pushes the given node on top of the given tagged stack.
+     * \param stack The tagged head of the stack
+     * \param node The index of the node plus one
+     */
+
+    void pushOnto(Opal::Atomic<uint64_t>&, uint32_t);
+
+    /*!
+     * Stores the given Opal::Task in an unused node.
+     * \param task The Opal::Task to store
+     * \return the index of the node plus one, or zero if there's no room
+     */
+
+    uint32_t store(Opal::Task&&);
+
+    /*!
+     * Destroys the Opal::Task of the given node and returns
+     * the node to the unused ones.
+     * \param node The node
+     */
+
+    void release(Node*);
+
+    /// --------------
+    /// Public Members
+
+public:
+
+    /// ------------
+    /// Constructors
+
+    /*!
+     * Default Constructor. Initializes an empty Opal::PathDeterminant.
+     */
+
+    PathDeterminant();
+
+    /*!
+     * Nodes point back at the Opal::PathDeterminant that owns them.
+     */
+
+    PathDeterminant(const PathDeterminant&)            = delete;
+    PathDeterminant& operator=(const PathDeterminant&) = delete;
+
+    /// --------------
+    /// Static Methods
+
+    /*!
+     * Returns a flag denoting if the given execution address
+     * represents a queued Opal::Task.
+     * \param address The execution address
+     * \return Opal::Flag denoting if the address is an Opal::Task
+     */
+
+    static Opal::Flag IsTask(void*);
+
+    /*!
+     * Returns the execution address that resumes the coroutine with the
+     * given frame. Queuing it queues the coroutine handle itself.
+     * \param frame The address of the coroutine's frame
+     * \return the execution address
+     */
+
+    static void* Continuation(void*);
+
+    /*!
+     * Returns a flag denoting if the given execution address
+     * resumes a coroutine.
+     * \param address The execution address
+     * \return Opal::Flag denoting if the address is a continuation
+     */
+
+    static Opal::Flag IsContinuation(void*);
+
+    /*!
+     * Returns the execution address that resumes the given green task.
+     * Green tasks are queued on their Opal::Saboteur, never in the paths.
+     * \param task The Opal::GreenTask
+     * \return the execution address
+     */
+
+    static void* Green(void*);
+
+    /*!
+     * Returns a flag denoting if the given execution address
+     * resumes a green task.
+     * \param address The execution address
+     * \return Opal::Flag denoting if the address is a green task
+     */
+
+    static Opal::Flag IsGreen(void*);
+
+    /*!
+     * Executes the given execution address. A queued Opal::Task is
+     * invoked and released, a continuation resumes its' coroutine, a
+     * green task is resumed on the invoking worker, and anything else
+     * is called as a function. Any thread may run an address taken
+     * from any Opal::PathDeterminant.
+     * \param address The execution address
+     */
+
+    static void Run(void*);
+
+    /*!
+     * Returns where the given execution address came from; the
+     * function itself, the kind of Opal::Task or green task, or the
+     * coroutine. Must be invoked before the address is run.
+     * \param address The execution address
+     * \return the source
+     */
+
+    static void* Source(void*);
+
+    /*!
+     * Releases the given execution address without executing it.
+     * A queued Opal::Task is destroyed and a continuation destroys
+     * its' coroutine; plain execution addresses hold nothing.
+     * \param address The execution address
+     */
+
+    static void Discard(void*);
+
+    /// -------
+    /// Methods
+
+    /*!
+     * Pushes the given execution address to the highest priority.
+     * \param address The execution address
+     * \return Opal::Flag denoting if the address was pushed; false if
+     * the Opal::PathDeterminant is full.
+     */
+
+    Opal::Flag push(void*);
+
+    /*!
+     * Places the given execution address at the lowest priority.
+     * \param address The execution address
+     * \return Opal::Flag denoting if the address was placed; false if
+     * the Opal::PathDeterminant is full.
+     */
+
+    Opal::Flag place(void*);
+
+    /*!
+     * Pushes the given Opal::Task to the highest priority.
+     * \param task The Opal::Task; left untouched if there's no room
+     * \return Opal::Flag denoting if the Opal::Task was pushed; false if
+     * the Opal::PathDeterminant is full.
+     */
+
+    Opal::Flag push(Opal::Task&&);
+
+    /*!
+     * Places the given Opal::Task at the lowest priority.
+     * \param task The Opal::Task; left untouched if there's no room
+     * \return Opal::Flag denoting if the Opal::Task was placed; false if
+     * the Opal::PathDeterminant is full.
+     */
+
+    Opal::Flag place(Opal::Task&&);
+
+    /*!
+     * Removes and returns the highest priority execution address.
+     * A queued Opal::Task must be handed to Run() or Discard().
+     * \param queued Where the time the address was queued goes, if
+     * anywhere; zero if it wasn't stamped
+     * \return the execution address, or null if there is none.
+     */
+
+    void* take(Opal::Nanoseconds* =0);
+
+    /*!
+     * Sets whether execution addresses are stamped with the time
+     * they're queued at.
+     * \param stamping Denotes if addresses are stamped
+     */
+
+    void setStamping(Opal::Flag);
+
+    /*!
+     * Returns a flag denoting if the Opal::PathDeterminant holds
+     * no execution addresses.
+     * \return Opal::Flag denoting if the Opal::PathDeterminant is empty
+     */
+
+    Opal::Flag isEmpty();
+
+};
+
+#endif
@@ -0,0 +1,162 @@
+/*!
+ * \brief Placement class
+ *
+ * Opal::Placement declaration. Describes where an Opal::Saboteur runs;
+ * the set of cpus its' thread may be scheduled on, and the NUMA node
+ * its' memory should come from. A default Opal::Placement leaves the
+ * thread wherever its' creator was allowed to run. An Opal::Placement
+ * also carries the STACK_* options the thread's stack is mapped with.
+ *
+ * \author Carlos L. Cuenca
+ * \version 0.1.0
+ * \date 02/07/2022
+ */
+
+#ifndef OPAL_PLACEMENT_HPP
+#define OPAL_PLACEMENT_HPP
+
+/// --------
+/// Includes
+
+#include<sched.h>
+#include<sys/types.h>
+#include<Types.hpp>
+#include<StackArena.hpp>
+
+namespace Opal { class Placement; }
+
+/// -----------------
+/// Class Declaration
+
+class Opal::Placement {
+
+    /// ---------------
+    /// Private Members
+
+private:
+
+    /// ----------------
+    /// Member Variables
+
+    cpu_set_t       cpus    ; /*< The cpus the thread may run on                        */
+    int32_t         node    ; /*< The NUMA node memory comes from, negative if any      */
+    Opal::Flag      pinned  ; /*< Denotes if the cpu set applies                        */
+    uint32_t        stack   ; /*< The options the thread's stack is mapped with         */
+
+    /// --------------
+    /// Public Members
+
+public:
+
+    /// ------------
+    /// Constructors
+
+    /*!
+     * Default Constructor. Leaves the thread and its' memory
+     * wherever they would have gone anyway.
+     */
+
+    Placement();
+
+    /*!
+     * Pins the thread to the given cpu and its' memory to the
+     * node the cpu belongs to.
+     * \param cpu The cpu to pin to
+     */
+
+    Placement(uint32_t);
+
+    /*!
+     * Pins the thread to the given cpu set and its' memory to
+     * the given node.
+     * \param cpus The cpus the thread may run on
+     * \param node The NUMA node, negative for any
+     */
+
+    Placement(const cpu_set_t&, int32_t);
+
+    /// --------------
+    /// Static Methods
+
+    /*!
+     * Returns the NUMA node the given cpu belongs to.
+     * \param cpu The cpu
+     * \return the node, or negative if it couldn't be determined.
+     */
+
+    static int32_t NodeOf(uint32_t);
+
+    /*!
+     * Fills the given array with one Opal::Placement per physical
+     * core the invoking thread may run on; hyperthread siblings are
+     * skipped. Cores are ordered by node, so a prefix of the layout
+     * stays on as few nodes as possible.
+     * \param placements The array to fill
+     * \param count The capacity of the array
+     * \return the amount of Opal::Placements written
+     */
+
+    static uint32_t PhysicalCores(Opal::Placement*, uint32_t);
+
+    /// -------
+    /// Methods
+
+    /*!
+     * Restricts the given thread to the cpu set, if there is one.
+     * \param threadID The thread to restrict
+     * \return Opal::Flag denoting if the thread was restricted
+     */
+
+    Opal::Flag apply(pid_t) const;
+
+    /*!
+     * Prefers the node for the pages of the given range, moving the
+     * ones that are already somewhere else. Only whole pages inside
+     * the range are affected.
+     * \param address The start of the range
+     * \param size The size of the range in bytes
+     * \return Opal::Flag denoting if the policy was set
+     */
+
+    Opal::Flag bind(void*, uint64_t) const;
+
+    /*!
+     * Returns a flag denoting if the Opal::Placement pins the thread.
+     * \return Opal::Flag denoting if the thread is pinned
+     */
+
+    Opal::Flag isPinned() const;
+
+    /*!
+     * Returns the NUMA node of the Opal::Placement.
+     * \return the node, or negative for any
+     */
+
+    int32_t getNode() const;
+
+    /*!
+     * Returns the cpus of the Opal::Placement.
+     * \return Reference to the cpu set
+     */
+
+    const cpu_set_t& getCPUs() const;
+
+    /*!
+     * Sets the STACK_* options the thread's stack is mapped with.
+     * Only takes effect for threads created afterwards.
+     * \param options The stack options
+     * \return Reference to the Opal::Placement
+     */
+
+    Opal::Placement& setStackOptions(uint32_t);
+
+    /*!
+     * Returns the STACK_* options the thread's stack is mapped with.
+     * \return the stack options
+     */
+
+    uint32_t getStackOptions() const;
+
+};
+
+#endif
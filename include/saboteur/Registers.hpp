@@ -0,0 +1,134 @@
+/*!
+ * \brief Registers class
+ *
+ * Opal::Registers declaration. A snapshot of the general purpose
+ * registers of a stopped Opal::Saboteur, as read and written through
+ * PTRACE_GETREGSET and PTRACE_SETREGSET. Each Opal::Saboteur owns one,
+ * so sampling or redirecting never allocates.
+ *
+ * \author Carlos L. Cuenca
+ * \version 0.1.0
+ * \date 02/07/2022
+ */
+
+#ifndef OPAL_REGISTERS_HPP
+#define OPAL_REGISTERS_HPP
+
+/// --------
+/// Includes
+
+#include<elf.h>
+#include<sys/uio.h>
+#include<sys/user.h>
+#include<Types.hpp>
+
+namespace Opal { class Registers; }
+
+/// -----------------
+/// Class Declaration
+
+class Opal::Registers {
+
+    /// ---------------
+    /// Private Members
+
+private:
+
+    /// ----------------
+    /// Member Variables
+
+    user_regs_struct    values      ; /*< The register contents                         */
+    struct iovec        vector      ; /*< Describes the contents to the register set    */
+
+    /// --------------
+    /// Public Members
+
+public:
+
+    /// ------------
+    /// Constructors
+
+    /*!
+     * Default Constructor. Initializes a zeroed snapshot.
+     */
+
+    Registers(): values(), vector() {
+
+        vector.iov_base = &values;
+        vector.iov_len  = sizeof(values);
+
+    }
+
+    /*!
+     * The vector points into the snapshot itself, so copies
+     * would point into the original.
+     */
+
+    Registers(const Registers&)            = delete;
+    Registers& operator=(const Registers&) = delete;
+
+    /// -------
+    /// Methods
+
+    /*!
+     * Returns the vector to hand to PTRACE_GETREGSET or
+     * PTRACE_SETREGSET. The length is reset on every call, since
+     * PTRACE_GETREGSET writes back the amount it filled in.
+     * \return Pointer to the vector
+     */
+
+    struct iovec* getVector() { vector.iov_len = sizeof(values); return &vector; }
+
+    /*!
+     * Returns the register contents for anything the accessors
+     * don't cover.
+     * \return Reference to the register contents
+     */
+
+    user_regs_struct& getValues() { return values; }
+
+    /*!
+     * Returns the instruction pointer.
+     * \return the instruction pointer
+     */
+
+    void* getInstructionPointer() { return reinterpret_cast<void*>(values.rip); }
+
+    /*!
+     * Returns the stack pointer.
+     * \return the stack pointer
+     */
+
+    void* getStackPointer() { return reinterpret_cast<void*>(values.rsp); }
+
+    /*!
+     * Returns the base pointer.
+     * \return the base pointer
+     */
+
+    void* getBasePointer() { return reinterpret_cast<void*>(values.rbp); }
+
+    /*!
+     * Sets the instruction pointer.
+     * \param address The instruction pointer
+     */
+
+    void setInstructionPointer(void* address) { values.rip = reinterpret_cast<uint64_t>(address); }
+
+    /*!
+     * Sets the stack pointer.
+     * \param address The stack pointer
+     */
+
+    void setStackPointer(void* address) { values.rsp = reinterpret_cast<uint64_t>(address); }
+
+    /*!
+     * Sets the base pointer.
+     * \param address The base pointer
+     */
+
+    void setBasePointer(void* address) { values.rbp = reinterpret_cast<uint64_t>(address); }
+
+};
+
+#endif
@@ -22,7 +22,9 @@
 
 #include<pthread.h> // Remove me
 #include<cstring> // remove me
-#include<iostream>
+#include<cerrno>
+#include<csignal>
+#include<linux/futex.h>
 #include<sched.h>
 #include<sys/syscall.h>
 #include<sys/types.h>
@@ -34,8 +36,18 @@
 #include<unistd.h>
 #include<Types.hpp>
 #include<SaboteurObserver.hpp>
-
-namespace Opal { class Saboteur; }
+#include<Counters.hpp>
+#include<EventRing.hpp>
+#include<GreenQueue.hpp>
+#include<Histogram.hpp>
+#include<PathDeterminant.hpp>
+#include<Placement.hpp>
+#include<Registers.hpp>
+#include<StackArena.hpp>
+#include<StealingDeque.hpp>
+#include<Trace.hpp>
+
+namespace Opal { class Saboteur; class GreenTask; }
 
 extern "C" void Lifecycle(void*);
 
@@ -133,6 +145,141 @@ extern "C" void Lifecycle(void*);
 
 #define ATTACHED 0x0000000000000801
 
+/// -----------------------------
+/// Opal::Saboteur Redirect Modes
+
+/*!
+ * \def REDIRECT_PTRACE
+ * \brief push() redirects a running Opal::Saboteur by rewriting its'
+ * registers through ptrace. Only the tracing thread may push.
+ */
+
+#define REDIRECT_PTRACE 0x00000000
+
+/*!
+ * \def REDIRECT_SIGNAL
+ * \brief push() redirects a running Opal::Saboteur by sending it a
+ * real-time signal. Any thread may push.
+ */
+
+#define REDIRECT_SIGNAL 0x00000001
+
+/// ---------------------------------
+/// Opal::Saboteur Latency Histograms
+
+/*!
+ * \def HISTOGRAM_QUEUED
+ * \brief The time from queuing an execution address in the paths
+ * until the Opal::Saboteur starts it.
+ */
+
+#define HISTOGRAM_QUEUED 0x00000000
+
+/*!
+ * \def HISTOGRAM_RUN
+ * \brief The time from starting execution until the Opal::Saboteur
+ * is waiting again.
+ */
+
+#define HISTOGRAM_RUN 0x00000001
+
+/*!
+ * \def HISTOGRAM_SUSPEND
+ * \brief The time from interrupting a running Opal::Saboteur until
+ * it's suspended.
+ */
+
+#define HISTOGRAM_SUSPEND 0x00000002
+
+/*!
+ * \def HISTOGRAM_RESUME
+ * \brief The time from resuming a suspended Opal::Saboteur until
+ * it's been continued.
+ */
+
+#define HISTOGRAM_RESUME 0x00000003
+
+/*!
+ * \def HISTOGRAM_CREATE
+ * \brief The time from creating an Opal::Saboteur until it first waits.
+ */
+
+#define HISTOGRAM_CREATE 0x00000004
+
+/*!
+ * \def HISTOGRAM_MIGRATE
+ * \brief The time a green task that migrated to the Opal::Saboteur
+ * spent between its' previous one stopping and continuing it here.
+ */
+
+#define HISTOGRAM_MIGRATE 0x00000005
+
+/*!
+ * \def HISTOGRAM_COUNT
+ * \brief The amount of latency histograms an Opal::Saboteur records.
+ */
+
+#define HISTOGRAM_COUNT 0x00000006
+
+/// -----------------------------
+/// Opal::Saboteur Observer Events
+
+/*!
+ * \def ON_CREATED
+ * \brief Event mask bit for the created callback.
+ */
+
+#define ON_CREATED 0x00000001
+
+/*!
+ * \def ON_WAITING
+ * \brief Event mask bit for the waiting callback.
+ */
+
+#define ON_WAITING 0x00000002
+
+/*!
+ * \def ON_STARTED
+ * \brief Event mask bit for the started callback.
+ */
+
+#define ON_STARTED 0x00000004
+
+/*!
+ * \def ON_SUSPENDED
+ * \brief Event mask bit for the suspended callback.
+ */
+
+#define ON_SUSPENDED 0x00000008
+
+/*!
+ * \def ON_RESUME
+ * \brief Event mask bit for the resume callback.
+ */
+
+#define ON_RESUME 0x00000010
+
+/*!
+ * \def ON_SUICIDE
+ * \brief Event mask bit for the suicide callback.
+ */
+
+#define ON_SUICIDE 0x00000020
+
+/*!
+ * \def ON_TERMINATED
+ * \brief Event mask bit for the terminated callback.
+ */
+
+#define ON_TERMINATED 0x00000040
+
+/*!
+ * \def ON_ALL
+ * \brief Event mask of every callback.
+ */
+
+#define ON_ALL 0x0000007f
+
 /// --------------
 /// General Macros
 
@@ -225,6 +372,54 @@ private:
 
     static const Opal::CloneFlags CloneFlags;
 
+    /*!
+     * The amount of spins an idle Opal::Saboteur performs
+     * before it parks on its' wake sequence.
+     */
+
+    static const uint32_t DefaultSpinBudget;
+
+    /*!
+     * The usable size in bytes of a Opal::Saboteur's stack
+     * when none is given.
+     */
+
+    static const uint64_t DefaultStackSize;
+
+    /*!
+     * The Opal::StackArena every Opal::Saboteur stack is
+     * allocated from and released to.
+     */
+
+    static Opal::StackArena Stacks;
+
+    /*!
+     * The real-time signal that redirects an Opal::Saboteur
+     * in REDIRECT_SIGNAL mode.
+     */
+
+    static const int RedirectSignal;
+
+    /*!
+     * The usable size in bytes of the alternate stack the redirect
+     * signal is handled on.
+     */
+
+    static const uint64_t SignalStackSize;
+
+    /*!
+     * The real-time signal an expired time slice raises.
+     */
+
+    static const int SliceSignal;
+
+    /*!
+     * The least room in bytes a green stack needs below the interrupted
+     * stack pointer for the green task to be preempted.
+     */
+
+    static const uint64_t SliceHeadroom;
+
     /// ----------------
     /// Member Variables
 
@@ -240,14 +435,56 @@ private:
     /// 64 Bytes long
     /// !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
     */
-    Opal::ThreadID              threadID            ; /*< The thread id corresponding with the thread                               */ // 8 Bytes
-    Opal::State                 state               ; /*< The value that denotes the current state of the Opal::Saboteur          */ // 8 Bytes
-    uint64_t*                   stack               ; /*< The stack that is allocated for this thread                               */ // 8 Bytes
-    uint64_t                    stackSize           ; /*< The size of the stack                                                     */ // 8 Bytes
-    Opal::SaboteurObserver*     observer            ; /*< The observer that receives callbacks from the Opal::Saboteur instance   */
-    int (*stop)(int32_t, int32_t)                   ;
-    Opal::Mutex                 stateMutex          ; /*< Mutex that corresponds to state changes                                   */
-    void*                       executionAddress    ; /*< The address of the instruction the thread should resume from              */ // 8 Bytes
+    Opal::ThreadID              threadID { 0 }                   ; /*< The thread id corresponding with the thread                               */ // 8 Bytes
+    Opal::Atomic<Opal::State>   state { CLEAR }                  ; /*< The value that denotes the current state of the Opal::Saboteur          */ // 8 Bytes
+    uint64_t*                   stack { 0 }                      ; /*< The stack that is allocated for this thread                               */ // 8 Bytes
+    uint64_t                    stackSize { DefaultStackSize }   ; /*< The size of the stack in bytes                                            */ // 8 Bytes
+    Opal::SaboteurObserver*     observer { 0 }                   ; /*< The observer that receives callbacks from the Opal::Saboteur instance   */
+    int (*stop)(int32_t, int32_t) { 0 }                          ;
+    Opal::Atomic<Opal::State>   resumeState { STARTED }          ; /*< The state the Opal::Saboteur was in before it was suspended               */ // 8 Bytes
+    void*                       executionAddress { 0 }           ; /*< The address of the instruction the thread should resume from              */ // 8 Bytes
+    Opal::Atomic<uint32_t>      wakeSequence { 0 }               ; /*< Futex word the Opal::Saboteur parks on while waiting                      */ // 4 Bytes
+    Opal::Atomic<uint32_t>      parked { 0 }                     ; /*< Denotes if the Opal::Saboteur is asleep on the wake sequence              */ // 4 Bytes
+    uint32_t                    spinBudget { DefaultSpinBudget } ; /*< The amount of spins before the Opal::Saboteur parks                       */ // 4 Bytes
+    Opal::Atomic<uint64_t>      unparkedAt { 0 }                 ; /*< Timestamp of the most recent wake request                                 */ // 8 Bytes
+    Opal::Atomic<uint64_t>      wakeLatency { 0 }                ; /*< Time between the most recent wake request and the wake                    */ // 8 Bytes
+    Opal::PathDeterminant       paths                            ; /*< The execution addresses the Opal::Saboteur has yet to execute           */
+    Opal::StealingDeque         deque                            ; /*< Execution addresses taken off the paths that siblings may steal           */
+    Opal::Atomic<Saboteur**>    siblings { 0 }                   ; /*< The group the Opal::Saboteur steals from, null if it doesn't steal       */
+    uint32_t                    siblingCount { 0 }               ; /*< The amount of Opal::Saboteurs in the group                                */ // 4 Bytes
+    uint32_t                    victim { 0 }                     ; /*< The sibling the next steal attempt starts at                              */ // 4 Bytes
+    Opal::Atomic<uint64_t>      steals { 0 }                     ; /*< The amount of execution addresses stolen from siblings                    */ // 8 Bytes
+    Opal::Atomic<uint64_t>      stealFailures { 0 }              ; /*< The amount of steal attempts that came up empty                           */ // 8 Bytes
+    Opal::Atomic<uint32_t>      childID { 0 }                    ; /*< The thread id while the thread is alive, zero once it has exited          */ // 4 Bytes
+    Opal::Atomic<uint32_t>      redirectMode { REDIRECT_PTRACE } ; /*< How push() redirects the running Opal::Saboteur                          */ // 4 Bytes
+    Opal::Atomic<uint8_t*>      signalStack { 0 }                ; /*< The alternate stack the redirect signal is handled on                     */ // 8 Bytes
+    uint8_t*                    installedStack { 0 }             ; /*< The alternate stack the thread has installed                              */ // 8 Bytes
+    Opal::Registers             registers                        ; /*< The most recent register snapshot                                         */
+    void*                       staticObserver { 0 }             ; /*< The observer of a statically dispatched Opal::Saboteur                    */ // 8 Bytes
+    void (*dispatch)(void*, void*, Opal::State) { 0 }            ; /*< Dispatches to the static observer, null if there is none                  */ // 8 Bytes
+    Opal::EventMask             events { 0 }                     ; /*< The events the static observer consumes                                   */ // 4 Bytes
+    Opal::Atomic<Opal::EventRing*> eventRing { 0 }               ; /*< Transitions awaiting delivery, null if delivered inline                   */ // 8 Bytes
+    Opal::Placement             placement                        ; /*< The cpus and NUMA node the Opal::Saboteur lives on                        */
+    Opal::GreenQueue            greens                           ; /*< The green tasks waiting for their turn on the Opal::Saboteur              */
+    Opal::GreenQueue            demoted                          ; /*< The green tasks preempted at the end of their time slice                  */
+    Opal::Atomic<Opal::Nanoseconds> timeSlice { 0 }              ; /*< The cpu time the running code gets before it's preempted, 0 if unlimited  */ // 8 Bytes
+    Opal::Nanoseconds           armedSlice { 0 }                 ; /*< The time slice the thread's timer is armed with                           */ // 8 Bytes
+    int32_t                     sliceTimer { -1 }                ; /*< The thread's cpu time timer, -1 if there is none                          */ // 4 Bytes
+    Opal::Atomic<uint64_t>      preemptions { 0 }                ; /*< The amount of times running code was preempted by its' time slice         */ // 8 Bytes
+    Opal::Atomic<Opal::Counters*> counters { 0 }                 ; /*< The hardware counters of the thread, if it's being counted                */ // 8 Bytes
+    Opal::Atomic<Opal::Histogram*> histograms { 0 }              ; /*< The latency histograms, null if they're not recorded                      */ // 8 Bytes
+    Opal::Nanoseconds           queuedAt { 0 }                   ; /*< When the next execution address was queued, 0 if unknown                  */ // 8 Bytes
+    Opal::Nanoseconds           startedAt { 0 }                  ; /*< When the running execution started                                        */ // 8 Bytes
+    Opal::Atomic<Opal::Nanoseconds> createdAt { 0 }              ; /*< When the thread was created, 0 once it has waited                         */ // 8 Bytes
+    Opal::Atomic<Opal::Nanoseconds> createLatency { 0 }          ; /*< The time it took to first wait, until it's recorded                       */ // 8 Bytes
+    Opal::Atomic<Opal::Nanoseconds> suspendingAt { 0 }           ; /*< When the thread was interrupted, 0 if it wasn't                           */ // 8 Bytes
+    Opal::Atomic<Opal::Nanoseconds> resumingAt { 0 }             ; /*< When the thread was resumed, 0 if it wasn't                               */ // 8 Bytes
+    Opal::Atomic<uint64_t>      migrations { 0 }                 ; /*< The amount of green tasks that migrated to the Opal::Saboteur             */ // 8 Bytes
+    int32_t                     pidfd { -1 }                     ; /*< The pidfd of the thread, -1 if there is none                              */ // 4 Bytes
+
+#if OPAL_TRACE_LEVEL > OPAL_TRACE_NONE
+    Opal::TraceRing             trace                            ; /*< The trace records of the Opal::Saboteur                                   */
+#endif
 
     /// --------------
     /// Static Methods
@@ -262,6 +499,15 @@ private:
 
     static void Resume(Saboteur*);
 
+    /*!
+     * Gets the given Opal::Saboteur to execute its' highest priority
+     * execution address as soon as possible. Running code is preempted
+     * by the redirect signal; otherwise the address gets picked up once
+     * it's woken. Only for Opal::Saboteurs in REDIRECT_SIGNAL mode.
+     */
+
+    static void Preempt(Saboteur*);
+
     /*!
      * Stops the thread represented by the Opal::Saboteur.
      * If the suspension fails, this function will throw a
@@ -272,6 +518,152 @@ private:
 
     static void Suspend(Saboteur*);
 
+    /*!
+     * Returns a flag denoting if the given Opal::State can
+     * be transitioned to from the current Opal::State.
+     * \param current The Opal::State the Opal::Saboteur is in
+     * \param state The Opal::State to transition to
+     * \return Opal::Flag denoting if the transition is permitted
+     */
+
+    static Opal::Flag IsTransition(Opal::State, Opal::State);
+
+    /*!
+     * Returns a flag denoting if the given Opal::State mask
+     * contains every bit of the given Opal::State.
+     * \param mask The combined Opal::State values
+     * \param state The Opal::State to look for
+     * \return Opal::Flag denoting if the state is part of the mask
+     */
+
+    static Opal::Flag Matches(Opal::State, Opal::State);
+
+    /*!
+     * Parks the Opal::Saboteur until either an execution address
+     * is assigned or it is set to terminate. The Opal::Saboteur
+     * spins for its' spin budget before it sleeps on its' wake sequence.
+     * This function should only be invoked by the Opal::Saboteur itself.
+     * \param thread The Opal::Saboteur to park
+     */
+
+    static void Park(Saboteur*);
+
+    /*!
+     * Wakes the given Opal::Saboteur if it's parked. Only the
+     * given Opal::Saboteur is woken.
+     * \param thread The Opal::Saboteur to wake
+     */
+
+    static void Unpark(Saboteur*);
+
+    /*!
+     * Returns a flag denoting if the given Opal::Saboteur has
+     * something to do; an execution address of its' own, one it could
+     * steal from a sibling, or being set to terminate.
+     * \param thread The Opal::Saboteur to check
+     */
+
+    static Opal::Flag HasWork(Saboteur*);
+
+    /*!
+     * Returns the next execution address the given Opal::Saboteur
+     * should execute. Its' own deque is drained first, oldest first,
+     * then its' paths. When stealing, a bounded batch of the paths'
+     * surplus moves to the deque where siblings can get to it, and an
+     * Opal::Saboteur with nothing of its' own steals from the top of a
+     * sibling's deque.
+     * This function should only be invoked by the Opal::Saboteur itself.
+     * \param thread The Opal::Saboteur looking for work
+     * \return the execution address, or null if there is none.
+     */
+
+    static void* Next(Saboteur*);
+
+    /*!
+     * Returns the next green task the given Opal::Saboteur should
+     * resume. Ready green tasks go first, preempted ones after.
+     * This function should only be invoked by the Opal::Saboteur itself.
+     * \param thread The Opal::Saboteur looking for a green task
+     * \return the green task, or null if there is none.
+     */
+
+    static Opal::GreenTask* NextGreen(Saboteur*);
+
+    /*!
+     * Runs the given execution address on the given Opal::Saboteur,
+     * attributing what its' counters counted to where it came from
+     * if it's being counted.
+     * This function should only be invoked by the Opal::Saboteur itself.
+     * \param thread The Opal::Saboteur running the address
+     * \param executionAddress The execution address
+     */
+
+    static void Execute(Saboteur*, void*);
+
+    /*!
+     * Installs the redirect and time slice signal handlers. Returns zero
+     * on success. This function is invoked once, by the first
+     * Opal::Saboteur that's set to REDIRECT_SIGNAL.
+     */
+
+    static int InstallRedirect();
+
+    /*!
+     * Installs the given Opal::Saboteur's alternate signal stack if it
+     * has been handed one since the last time. This function should
+     * only be invoked by the Opal::Saboteur itself.
+     * \param thread The Opal::Saboteur to install the stack for
+     */
+
+    static void InstallSignalStack(Saboteur*);
+
+    /*!
+     * Arms the given Opal::Saboteur's cpu time timer with its' time
+     * slice if it has changed since the last time, creating the timer
+     * the first time around. This function should only be invoked by
+     * the Opal::Saboteur itself, since the timer measures the thread
+     * that creates it.
+     * \param thread The Opal::Saboteur to arm the timer for
+     */
+
+    static void InstallTimeSlice(Saboteur*);
+
+    /*!
+     * Rewrites the given interrupted context so it calls the given
+     * execution address through the trampoline as soon as the handler
+     * returns, and continues where it was interrupted once it returns.
+     * \param context The interrupted context
+     * \param executionAddress The execution address to call
+     * \param paths The paths to drain before continuing, or null
+     */
+
+    static void Divert(void*, void*, Opal::PathDeterminant*);
+
+    /*!
+     * The redirect signal handler. Takes the highest priority execution
+     * address and rewrites the interrupted context so the address is
+     * called as soon as the handler returns. The interrupted context
+     * continues once the call returns, with its' registers intact.
+     * \param signal The redirect signal
+     * \param information The signal information; carries the Opal::Saboteur
+     * \param context The interrupted context
+     */
+
+    static void Redirect(int, siginfo_t*, void*);
+
+    /*!
+     * The time slice signal handler. Preempts whatever the Opal::Saboteur
+     * is running if something is waiting behind it. An interrupted green
+     * task is switched out and queued behind the green tasks that are
+     * ready; anything else has everything waiting in the paths run on
+     * top of it, the same way a redirect runs one execution address.
+     * \param signal The time slice signal
+     * \param information The signal information; carries the Opal::Saboteur
+     * \param context The interrupted context
+     */
+
+    static void Slice(int, siginfo_t*, void*);
+
     /*!
      * Creates the thread of execution and binds it to the given
      * Opal::Saboteur instance. This function ensures that a thread
@@ -281,8 +673,41 @@ private:
 
     static void Create(Saboteur*);
 
-    static void* RegistersOf(Saboteur*);
-    static void SetRegistersOf(Saboteur*, void*);
+    /*!
+     * Allocates the stack of the given Opal::Saboteur, clones its'
+     * thread, seizes it and asks it to stop, without waiting for it to.
+     * \param thread The Opal::Saboteur to launch
+     * \throws SaboteurCreateFailureException if the thread couldn't be created.
+     */
+
+    static void Launch(Saboteur*);
+
+    /*!
+     * Reaps the first stop of the given launched Opal::Saboteur and
+     * resumes it. Must be invoked by the thread that launched it.
+     * \param thread The Opal::Saboteur to settle
+     */
+
+    static void Settle(Saboteur*);
+
+    /*!
+     * Stops the given Opal::Saboteur if it isn't already and reads its'
+     * registers into its' snapshot. Must be invoked by the thread that
+     * created the Opal::Saboteur.
+     * \param thread The Opal::Saboteur to read
+     * \return Pointer to the snapshot, or null if the registers couldn't be read
+     */
+
+    static Opal::Registers* RegistersOf(Saboteur*);
+
+    /*!
+     * Writes the given Opal::Saboteur's snapshot back to its' registers.
+     * The Opal::Saboteur must have been stopped by RegistersOf.
+     * \param thread The Opal::Saboteur to write
+     * \return Opal::Flag denoting if the registers were written
+     */
+
+    static Opal::Flag SetRegistersOf(Saboteur*);
 
     /*!
      * The execution method of the Opal::Saboteur. Any Opal::Saboteur that's
@@ -311,7 +736,9 @@ private:
     void checkErrorState(Opal::State);
 
     /*!
-     * Sets the current state of the Opal::Saboteur.
+     * Sets the current state of the Opal::Saboteur. The transition
+     * is validated against the current state and applied atomically;
+     * the observer is notified once it has succeeded.
      * \param state the Opal::State value to set.
      */
 
@@ -327,6 +754,22 @@ private:
 
     Opal::Flag isIn(Opal::State);
 
+    /*!
+     * Notifies the observer, if any, of the given Opal::State.
+     * \param state The Opal::State transitioned to
+     */
+
+    void notify(Opal::State);
+
+    /*!
+     * Records the latencies the transition between the given
+     * Opal::States completes.
+     * \param previous The Opal::State transitioned from
+     * \param state The Opal::State transitioned to
+     */
+
+    void measure(Opal::State, Opal::State);
+
     /*!
      * Returns the value of the last address the Opal::Saboteur
      * resumed execution or will continue execution from a suspended
@@ -351,6 +794,61 @@ private:
 
     void setExecutionAddress(void*);
 
+    /// -----------------
+    /// Protected Members
+
+protected:
+
+    /// --------------
+    /// Static Methods
+
+    /*!
+     * Returns the observer event that corresponds with the
+     * given Opal::State, if any.
+     * \param state The Opal::State transitioned to
+     * \return the event mask bit of the Opal::State, or zero
+     */
+
+    static constexpr Opal::EventMask EventOf(Opal::State state) {
+
+        return state == CREATED     ? ON_CREATED    :
+               state == WAITING     ? ON_WAITING    :
+               state == STARTED     ? ON_STARTED    :
+               state == SUSPENDED   ? ON_SUSPENDED  :
+               state == RESUMING    ? ON_RESUME     :
+               state == SUICIDE     ? ON_SUICIDE    :
+               state == TERMINATED  ? ON_TERMINATED : 0;
+
+    }
+
+    /// ------------
+    /// Constructors
+
+    /*!
+     * Initializes the Opal::Saboteur with the given resume address and
+     * a statically dispatched observer. The dispatch function is only
+     * invoked for the events in the given mask.
+     * \param address The address to initialize the Opal::Saboteur with.
+     * \param observer The observer handed to the dispatch function
+     * \param dispatch The function that notifies the observer
+     * \param events The events the observer consumes
+     * \param stackSize The usable size of the stack in bytes
+     */
+
+    template<typename Address>
+    Saboteur(Address, void*, void (*)(void*, void*, Opal::State), Opal::EventMask, uint64_t);
+
+    /*!
+     * Initializes the Opal::Saboteur and launches its' thread without
+     * waiting for it to stop; whoever constructs it settles it.
+     * \param placement The cpus and NUMA node the Opal::Saboteur lives on
+     * \param observer The Opal::SaboteurObserver that receives callbacks
+     * from the Opal::Saboteur
+     * \param stackSize The usable size of the stack in bytes
+     */
+
+    Saboteur(const Opal::Placement&, Opal::SaboteurObserver*, uint64_t);
+
     /// --------------
     /// Public Members
 
@@ -371,9 +869,10 @@ public:
      * to its' default state with the given Opal::SaboteurObserver.
      * \param observer The Opal::SaboteurObserver to bind to the
      * Opal::Saboteur
+     * \param stackSize The usable size of the stack in bytes
      */
 
-    Saboteur(Opal::SaboteurObserver*);
+    Saboteur(Opal::SaboteurObserver*, uint64_t=DefaultStackSize);
 
     /*!
      * Primary Constructor. Initializes the Opal::Saboteur
@@ -390,18 +889,83 @@ public:
      * \param address The address to initialize the Opal::Saboteur with.
      * \param observer The Opal::SaboteurObserver that receives callbacks
      * from the Opal::Saboteur
+     * \param stackSize The usable size of the stack in bytes
+     * \param placement The cpus and NUMA node the Opal::Saboteur lives on
      */
 
     template<typename Address>
-    Saboteur(Address, Opal::SaboteurObserver*);
+    Saboteur(Address, Opal::SaboteurObserver*, uint64_t=DefaultStackSize, const Opal::Placement& =Opal::Placement());
 
     /*!
      * Deconstructor. Releases any resources used by the Opal::Saboteur.
-     * At the time of writing, no resources are used or released.
+     * A suspended Opal::Saboteur is resumed so it can terminate. The
+     * stack is returned to the Opal::StackArena once the
+     * Opal::Saboteur has terminated.
      */
 
     ~Saboteur();
 
+    /// --------------
+    /// Static Methods
+
+    /*!
+     * Stops every Opal::Saboteur in the given group. Every member is
+     * interrupted before any stop is reaped, so the members stop
+     * concurrently; this returns only once each member that was
+     * interrupted has reported its' stop (or exit). Members in
+     * REDIRECT_SIGNAL mode aren't traced, so they're skipped, as is
+     * any member the interrupt didn't reach. Must be invoked by the
+     * thread that created the group, since that's the thread tracing them.
+     * \param group The Opal::Saboteurs to stop
+     * \param count The amount of Opal::Saboteurs in the group
+     * \param stopped Where the amount of members that are stopped on
+     * return goes, if anywhere; those already suspended included
+     * \return Opal::Nanoseconds between the first interrupt and the last stop
+     */
+
+    static Opal::Nanoseconds SuspendAll(Saboteur**, uint32_t, uint32_t* =0);
+
+    /*!
+     * Creates the given amount of Opal::Saboteurs into the given group.
+     * Every thread is cloned, seized and interrupted before any first
+     * stop is reaped, so the threads start up concurrently instead of
+     * one round trip at a time. Any number of threads may spawn at
+     * once; each only reaps the stops of the threads it cloned, and
+     * traces them from then on.
+     * \param group Where the Opal::Saboteurs go
+     * \param count The amount of Opal::Saboteurs to create
+     * \param observer The Opal::SaboteurObserver of every Opal::Saboteur
+     * \param stackSize The usable size of each stack in bytes
+     * \param placements The placement of each Opal::Saboteur, or null
+     * \throws SaboteurCreateFailureException if a thread couldn't be
+     * created; the ones before it are created, the rest are null.
+     */
+
+    static void Spawn(Saboteur**, uint32_t, Opal::SaboteurObserver* =0, uint64_t=DefaultStackSize, const Opal::Placement* =0);
+
+    /*!
+     * Continues every suspended Opal::Saboteur in the given group.
+     * Must be invoked by the thread that created the group.
+     * \param group The Opal::Saboteurs to continue
+     * \param count The amount of Opal::Saboteurs in the group
+     * \return Opal::Nanoseconds it took to continue the group
+     */
+
+    static Opal::Nanoseconds ResumeAll(Saboteur**, uint32_t);
+
+    /*!
+     * Adds the given latency histogram of every Opal::Saboteur in the
+     * given group to the given Opal::Histogram. Members that don't
+     * record histograms are skipped.
+     * \param group The Opal::Saboteurs to aggregate
+     * \param count The amount of Opal::Saboteurs in the group
+     * \param histogram The HISTOGRAM_* to aggregate
+     * \param into The Opal::Histogram to add them to
+     * \return the amount of members that were added
+     */
+
+    static uint32_t MergeHistograms(Saboteur**, uint32_t, uint32_t, Opal::Histogram&);
+
     /*!
      * Swaps the Opal::Saboteur's resume and return
      * address and returns the previous resume and return address
@@ -426,7 +990,8 @@ public:
      * position, effectively holding off on executing the code
      * that was being executed at the time of invocation, if
      * the Opal::Saboteur was executing. This method will
-     * suspend the Opal::Saboteur.
+     * suspend the Opal::Saboteur. In REDIRECT_SIGNAL mode, any thread
+     * may push and the running code is preempted by a signal instead.
      * \param executionAddress The execution address to push
      * \param resume Opal::Flag denoting if the Opal::Saboteur
      * should be resumed after the completion of the operation.
@@ -435,13 +1000,15 @@ public:
     void push(void*, Opal::Flag=false);
 
     /*!
-     * Cancels the currently executing code (highest priority) the
-     * Opal::Saboteur was executing and returns the address of the
-     * instruction at the moment the Opal::thread
-     * was suspended. This method will suspend the Opal::Saboteur.
-     * \param executionAddress The execution address to push
+     * Cancels the highest priority execution address the
+     * Opal::Saboteur has yet to execute and returns it. Code
+     * that is already executing runs to completion. A cancelled
+     * Opal::Task is destroyed; what's returned for it only denotes
+     * that something was cancelled.
      * \param resume Opal::Flag denoting if the Opal::Saboteur
      * should be resumed after the completion of the operation.
+     * \return the cancelled execution address, or null if the
+     * Opal::PathDeterminant is empty.
      */
 
     void* pop(Opal::Flag=false);
@@ -449,16 +1016,120 @@ public:
     /*!
      * Places the given execution address at what might be considered
      * the lowest priority of the Opal::Saboteur's PathDeterminant.
-     * For example, if a queue is being used as the underlying structure
-     * of the Opal::PathDeterminant, then the execution address
-     * will be placed last.
-     * \param executionAddress The execution address to push
+     * The Opal::PathDeterminant is a queue at its' lowest priority, so
+     * the execution address will be placed last. Any number of threads
+     * may place at once.
+     * \param executionAddress The execution address to place
      * \param resume Opal::Flag denoting if the Opal::Saboteur
      * should be resumed after the completion of the operation.
+     * \return the placed execution address, or null if the
+     * Opal::PathDeterminant is full.
      */
 
     void* place(void*, Opal::Flag=false);
 
+    /*!
+     * Pushes the given Opal::Task to the highest priority position.
+     * The Opal::Task is stored in the Opal::Saboteur's paths, so small
+     * closures don't allocate. In REDIRECT_SIGNAL mode, running code is
+     * preempted by the Opal::Task; otherwise it runs once the running
+     * code returns.
+     * \param task The Opal::Task to push
+     * \param resume Opal::Flag denoting if the Opal::Saboteur
+     * should be resumed after the completion of the operation.
+     * \throws SaboteurPathsFullException if there's no room for the Opal::Task.
+     */
+
+    void push(Opal::Task&&, Opal::Flag=false);
+
+    /*!
+     * Places the given Opal::Task at the lowest priority position.
+     * The Opal::Task is stored in the Opal::Saboteur's paths, so small
+     * closures don't allocate. Any number of threads may place at once.
+     * \param task The Opal::Task to place; left untouched if there's no room
+     * \param resume Opal::Flag denoting if the Opal::Saboteur
+     * should be resumed after the completion of the operation.
+     * \return Opal::Flag denoting if the Opal::Task was placed; false if
+     * the Opal::PathDeterminant is full.
+     */
+
+    Opal::Flag place(Opal::Task&&, Opal::Flag=false);
+
+    /*!
+     * Spawns a green task that runs the given Opal::Task on the
+     * Opal::Saboteur. Green tasks take turns with each other behind
+     * the paths, each on its' own small stack, switching in user space
+     * whenever one relinquishes, suspends or finishes. See Opal::GreenTask.
+     * \param task The Opal::Task the green task runs
+     * \throws GreenTaskCreateFailureException if no green stack could be mapped.
+     */
+
+    void spawn(Opal::Task&&);
+
+    /*!
+     * Queues the given green task on the Opal::Saboteur. Any thread
+     * may queue; the Opal::Saboteur is woken unless told otherwise.
+     * \param task The green task to queue
+     * \param wake Opal::Flag denoting if the Opal::Saboteur should be woken
+     */
+
+    void enqueue(Opal::GreenTask*, Opal::Flag=true);
+
+    /*!
+     * Queues the given green task behind every green task that's ready;
+     * the green task was preempted at the end of its' time slice. Only
+     * the Opal::Saboteur itself may demote.
+     * \param task The green task to demote
+     */
+
+    void demote(Opal::GreenTask*);
+
+    /*!
+     * Moves the green task the Opal::Saboteur is running to the given
+     * Opal::Saboteur, without waiting for it to switch out. The thread
+     * is stopped, its' registers checkpointed and rewritten so the green
+     * task switches out to the target as soon as it's continued; its'
+     * stack goes along with it. Must be invoked by the thread that
+     * created the Opal::Saboteur. A suspended Opal::Saboteur stays
+     * suspended; the task moves once it's resumed. One in
+     * REDIRECT_SIGNAL mode can't be stopped, so nothing moves.
+     * \param target The Opal::Saboteur to move the green task to
+     * \return Opal::Flag denoting if a green task is being moved
+     */
+
+    Opal::Flag migrate(Saboteur*);
+
+    /*!
+     * Records a green task that migrated to the Opal::Saboteur, and
+     * how long it was paused for. Invoked as it's continued here.
+     * \param pause The time the green task was paused for
+     */
+
+    void migrated(Opal::Nanoseconds);
+
+    /*!
+     * Returns the amount of green tasks that migrated to the
+     * Opal::Saboteur.
+     * \return the amount of migrations
+     */
+
+    uint64_t getMigrations();
+
+    /*!
+     * Returns the pidfd of the Opal::Saboteur's thread. It becomes
+     * readable once the thread exits; see Opal::Supervisor.
+     * \return the pidfd, or -1 if the thread has none
+     */
+
+    int32_t getPidfd();
+
+    /*!
+     * Returns the id of the Opal::Saboteur's thread.
+     * \return the thread id, or 0 if there is no thread
+     */
+
+    Opal::ThreadID getThreadID();
+
     /*!
      * Suspends the thread. This method should be invoked by another
      * thread. This method stores the current instruction address to
@@ -481,6 +1152,231 @@ public:
 
     void resume();
 
+    /*!
+     * Sets the Opal::Saboteur to terminate once it has finished
+     * executing its' assigned code and wakes it if it's parked.
+     */
+
+    void terminate();
+
+    /*!
+     * Waits for the thread of the Opal::Saboteur to exit, however it
+     * got there. Sleeps on the thread id the kernel clears once the
+     * thread is off its' stack, so the wait costs a single wake.
+     * \param timeout The most time to wait, zero waits indefinitely
+     * \return Opal::Flag denoting if the thread has exited
+     */
+
+    Opal::Flag join(Opal::Nanoseconds=0);
+
+    /*!
+     * Sets the amount of spins an idle Opal::Saboteur performs
+     * before it parks. A value of zero parks immediately.
+     * \param spinBudget The amount of spins
+     */
+
+    void setSpinBudget(uint32_t);
+
+    /*!
+     * Returns the time elapsed between the most recent wake
+     * request and the Opal::Saboteur waking up from its' parked state.
+     * \return Opal::Nanoseconds of the most recent wake
+     */
+
+    Opal::Nanoseconds getWakeLatency();
+
+    /*!
+     * Returns the cpus and NUMA node the Opal::Saboteur lives on.
+     * \return Reference to the Opal::Placement
+     */
+
+    const Opal::Placement& getPlacement();
+
+    /*!
+     * Lets the Opal::Saboteur steal from the given group once it runs
+     * out of execution addresses of its' own. The group may include the
+     * Opal::Saboteur itself and must outlive it.
+     * \param siblings The Opal::Saboteurs to steal from
+     * \param count The amount of Opal::Saboteurs in the group
+     */
+
+    void setSiblings(Saboteur**, uint32_t);
+
+    /*!
+     * Returns the amount of execution addresses the Opal::Saboteur
+     * stole from its' siblings.
+     * \return the amount of steals
+     */
+
+    uint64_t getSteals();
+
+    /*!
+     * Returns the amount of times the Opal::Saboteur went looking for
+     * something to steal and came up empty.
+     * \return the amount of failed steal attempts
+     */
+
+    uint64_t getStealFailures();
+
+    /*!
+     * Sets how push() redirects the Opal::Saboteur while it's running.
+     * Switching to REDIRECT_SIGNAL detaches the thread from ptrace, so
+     * it must be invoked by the thread that created the Opal::Saboteur,
+     * and there's no switching back. A detached Opal::Saboteur can't be
+     * suspended through ptrace: SuspendAll() skips it, ResumeAll() has
+     * nothing to continue, RegistersOf() returns null and migrate()
+     * returns false.
+     * \param mode REDIRECT_PTRACE or REDIRECT_SIGNAL
+     */
+
+    void setRedirectMode(uint32_t);
+
+    /*!
+     * Returns how push() redirects the Opal::Saboteur while it's running.
+     * \return REDIRECT_PTRACE or REDIRECT_SIGNAL
+     */
+
+    uint32_t getRedirectMode();
+
+    /*!
+     * Sets the cpu time the Opal::Saboteur's running code gets before
+     * it's preempted in favor of whatever is waiting behind it. The
+     * slice is measured on a per-thread cpu time clock, so only time
+     * spent running counts. Setting a slice switches the Opal::Saboteur
+     * to REDIRECT_SIGNAL for good, with everything that entails: the
+     * thread is detached from ptrace, so the ptrace based APIs
+     * (SuspendAll(), ResumeAll(), RegistersOf(), migrate()) stop working
+     * for it. A slice of zero turns preemption off, but doesn't attach
+     * the thread again. Code that must not be interrupted by other
+     * work on the same thread (e.g. while holding a lock that work
+     * might take) shouldn't run under a time slice.
+     * \param slice The time slice in nanoseconds, 0 to turn it off
+     */
+
+    void setTimeSlice(Opal::Nanoseconds);
+
+    /*!
+     * Returns the cpu time the Opal::Saboteur's running code gets
+     * before it's preempted.
+     * \return the time slice in nanoseconds, 0 if there is none
+     */
+
+    Opal::Nanoseconds getTimeSlice();
+
+    /*!
+     * Returns the amount of times the Opal::Saboteur's running code
+     * was preempted at the end of its' time slice.
+     * \return the amount of preemptions
+     */
+
+    uint64_t getPreemptions();
+
+    /*!
+     * Opens a perf_event group on the Opal::Saboteur's thread. From then
+     * on, what every execution address it runs costs is attributed to
+     * where the address came from. Must be invoked once the thread exists.
+     * \param software Denotes if context switches and page faults are
+     * counted too; without them, the thread reads its' counters with rdpmc.
+     * \return Opal::Flag denoting if any counter could be opened
+     */
+
+    Opal::Flag openCounters(Opal::Flag=true);
+
+    /*!
+     * Returns the hardware counters of the Opal::Saboteur's thread.
+     * \return Pointer to the Opal::Counters, or null if openCounters()
+     * hasn't succeeded
+     */
+
+    Opal::Counters* getCounters();
+
+    /*!
+     * Sets the Opal::Saboteur to record its' latency histograms. There's
+     * no switching back. Recording never locks nor allocates.
+     */
+
+    void setHistograms();
+
+    /*!
+     * Returns the given latency histogram of the Opal::Saboteur.
+     * \param histogram The HISTOGRAM_* to return
+     * \return Pointer to the Opal::Histogram, or null if the Opal::Saboteur
+     * doesn't record histograms
+     */
+
+    const Opal::Histogram* getHistogram(uint32_t);
+
+    /*!
+     * Sets the Opal::Saboteur to record its' transitions instead of
+     * notifying the observer on the spot. The recorded transitions are
+     * delivered by whichever thread invokes dispatchEvents(). There's
+     * no switching back.
+     */
+
+    void setAsyncEvents();
+
+    /*!
+     * Delivers up to the given amount of recorded transitions to the
+     * observer, oldest first, on the invoking thread. Only one thread
+     * may dispatch at a time.
+     * \param count The most transitions to deliver
+     * \return the amount of transitions consumed from the record
+     */
+
+    uint64_t dispatchEvents(uint64_t=Opal::EventRing::Capacity);
+
+    /*!
+     * Returns the amount of transitions that weren't delivered
+     * because the record was full.
+     * \return the amount of dropped transitions
+     */
+
+    uint64_t getDroppedEvents();
+
+    /*!
+     * Returns the amount of transitions that weren't delivered
+     * because they were coalesced away.
+     * \return the amount of coalesced transitions
+     */
+
+    uint64_t getCoalescedEvents();
+
+    /*!
+     * Stops the Opal::Saboteur and takes a snapshot of its' registers.
+     * The snapshot is owned by the Opal::Saboteur and is overwritten by
+     * the next one; nothing is allocated. Must be invoked by the thread
+     * that created the Opal::Saboteur.
+     * \param resume Opal::Flag denoting if the Opal::Saboteur should be
+     * resumed once the snapshot is taken.
+     * \return Reference to the snapshot
+     * \throws SaboteurRegistersException if the registers couldn't be read.
+     */
+
+    Opal::Registers& snapshot(Opal::Flag=false);
+
+    /*!
+     * Writes the snapshot (presumably modified) back to the stopped
+     * Opal::Saboteur's registers. Must be invoked by the thread that
+     * created the Opal::Saboteur.
+     * \param resume Opal::Flag denoting if the Opal::Saboteur should be
+     * resumed once the registers are written.
+     * \throws SaboteurRegistersException if the registers couldn't be written.
+     */
+
+    void restore(Opal::Flag=false);
+
+#if OPAL_TRACE_LEVEL > OPAL_TRACE_NONE
+
+    /*!
+     * Returns the Opal::TraceRing the Opal::Saboteur records
+     * its' trace points to. Only available when tracing is compiled in.
+     * \return Opal::TraceRing of the Opal::Saboteur
+     */
+
+    Opal::TraceRing& getTrace();
+
+#endif
+
     /*!
      * Returns a flag denoting if the Opal::Saboteur should terminate
      * after execution of the current code, i.e. when it links to
@@ -519,6 +1415,52 @@ public:
 
     Opal::Flag isWaiting();
 
+#if __cpp_impl_coroutine
+
+    /// ----------
+    /// Coroutines
+
+    /*!
+     * Awaitable that moves the awaiting coroutine onto an
+     * Opal::Saboteur. The coroutine's handle is placed in the
+     * Opal::Saboteur's paths as is, so hopping allocates nothing.
+     */
+
+    class Schedule {
+
+        Opal::Saboteur& saboteur;
+
+    public:
+
+        explicit Schedule(Opal::Saboteur& saboteur): saboteur(saboteur) { /* Empty */ }
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+
+            // The coroutine may resume on the Opal::Saboteur before
+            // place returns; only the failure path touches it again.
+            if(!saboteur.place(Opal::PathDeterminant::Continuation(handle.address())))
+                throw SaboteurPathsFullException();
+
+        }
+
+        void await_resume() const noexcept { /* Empty */ }
+
+    };
+
+    /*!
+     * Returns an awaitable that continues the awaiting coroutine on
+     * the Opal::Saboteur, behind whatever it has yet to execute.
+     * \return Awaitable for co_await
+     * \throws SaboteurPathsFullException when awaited if the
+     * Opal::Saboteur's paths are full.
+     */
+
+    Schedule schedule() { return Schedule(*this); }
+
+#endif
+
     /// ----------
     /// Exceptions
 
@@ -642,6 +1584,36 @@ public:
 
     };
 
+    /*!
+     * Exception that gets thrown when the registers of a
+     * Opal::Saboteur could not be read or written
+     */
+
+    class SaboteurRegistersException : public Opal::Exception {
+
+        Opal::StringLiteral what() const throw() {
+
+            return "Error: Saboteur registers could not be accessed.";
+
+        }
+
+    };
+
+    /*!
+     * Exception that gets thrown when an execution address is pushed
+     * while the Opal::PathDeterminant is full.
+     */
+
+    class SaboteurPathsFullException : public Opal::Exception {
+
+        Opal::StringLiteral what() const throw() {
+
+            return "Error: Saboteur has no room for another execution address.";
+
+        }
+
+    };
+
     /*!
      * Exception that gets thrown when process attachement has failed
      */
@@ -665,9 +1637,13 @@ public:
  */
 
 template<typename Address>
-Opal::Saboteur::Saboteur(Address address):
-executionAddress(Indirect(address)), observer(0), threadID(0),
-state(0), stateMutex() { Create(this); }
+Opal::Saboteur::Saboteur(Address address) {
+
+    if(Indirect(address)) paths.place(Indirect(address));
+
+    Create(this);
+
+}
 
 /*!
  * Primary Constructor. Initializes the Opal::Saboteur
@@ -675,11 +1651,40 @@ state(0), stateMutex() { Create(this); }
  * \param address The address to initialize the Opal::Saboteur with.
  * \param observer The Opal::SaboteurObserver that receives callbacks
  * from the Opal::Saboteur
+ * \param stackSize The usable size of the stack in bytes
+ * \param placement The cpus and NUMA node the Opal::Saboteur lives on
  */
 
 template<typename Address>
-Opal::Saboteur::Saboteur(Address address, Opal::SaboteurObserver* observer):
-executionAddress(Indirect(address)), observer(observer), threadID(0),
-state(0), stateMutex() { Create(this); }
+Opal::Saboteur::Saboteur(Address address, Opal::SaboteurObserver* observer, uint64_t stackSize, const Opal::Placement& placement):
+stackSize(stackSize), observer(observer), placement(placement) {
+
+    if(Indirect(address)) paths.place(Indirect(address));
+
+    Create(this);
+
+}
+
+/*!
+ * Initializes the Opal::Saboteur with the given resume address and
+ * a statically dispatched observer. The dispatch function is only
+ * invoked for the events in the given mask.
+ * \param address The address to initialize the Opal::Saboteur with.
+ * \param observer The observer handed to the dispatch function
+ * \param dispatch The function that notifies the observer
+ * \param events The events the observer consumes
+ * \param stackSize The usable size of the stack in bytes
+ */
+
+template<typename Address>
+Opal::Saboteur::Saboteur(Address address, void* observer, void (*dispatch)(void*, void*, Opal::State),
+                         Opal::EventMask events, uint64_t stackSize):
+stackSize(stackSize), staticObserver(observer), dispatch(dispatch), events(events) {
+
+    if(Indirect(address)) paths.place(Indirect(address));
+
+    Create(this);
+
+}
 
 #endif
@@ -0,0 +1,356 @@
+/*!
+ * \brief SaboteurPool class
+ *
+ * Opal::SaboteurPool declaration. Spawns a fixed amount of
+ * Opal::Saboteur workers up front and hands submitted execution
+ * addresses to them. Since the workers already exist, a submission
+ * costs a queue insertion and a wake instead of a clone and a trace.
+ * Optionally, the workers steal from each other once they run out
+ * of execution addresses of their own, and are pinned to cpus.
+ *
+ * \author Carlos L. Cuenca
+ * \version 0.1.0
+ * \date 02/07/2022
+ */
+
+#ifndef OPAL_SABOTEUR_POOL_HPP
+#define OPAL_SABOTEUR_POOL_HPP
+
+/// --------
+/// Includes
+
+#include<Types.hpp>
+#include<Saboteur.hpp>
+
+namespace Opal { class SaboteurPool; }
+
+/// -----------------
+/// Class Declaration
+
+class Opal::SaboteurPool {
+
+    /// ---------------
+    /// Private Members
+
+private:
+
+    /*!
+     * The amount of workers a default Opal::SaboteurPool spawns.
+     */
+
+    static const uint32_t DefaultSize = 4;
+
+    /// ----------------
+    /// Member Variables
+
+    Opal::Saboteur**        workers     ; /*< The spawned workers                           */
+    uint32_t                size        ; /*< The amount of workers                         */
+    Opal::Atomic<uint32_t>  next        ; /*< The worker the next submission starts at      */
+
+    /// -------
+    /// Methods
+
+    /*!
+     * Spawns a worker for each slot of the pool.
+     * \param placements The placement of each worker, or null
+     * \param observer The Opal::SaboteurObserver of every worker
+     * \param stackSize The usable size of each worker's stack in bytes
+     * \param stealing Denotes if idle workers steal from busy ones
+     * \throws SaboteurCreateFailureException if a worker couldn't be
+     * created; every worker that was is released first.
+     */
+
+    void spawn(const Opal::Placement*, Opal::SaboteurObserver*, uint64_t, Opal::Flag);
+
+    /*!
+     * Makes sure every worker is still attached through ptrace.
+     * \throws SaboteurPoolDetachedException if a worker has a time slice.
+     */
+
+    void checkAttached();
+
+    /// --------------
+    /// Public Members
+
+public:
+
+    /// ------------
+    /// Constructors
+
+    /*!
+     * Primary Constructor. Spawns the given amount of workers, each
+     * with the given stack size.
+     * \param size The amount of workers
+     * \param observer The Opal::SaboteurObserver that receives callbacks
+     * from every worker
+     * \param stackSize The usable size of each worker's stack in bytes
+     * \param stealing Denotes if idle workers steal from busy ones
+     */
+
+    SaboteurPool(uint32_t=DefaultSize, Opal::SaboteurObserver* =0, uint64_t=8 * 1024 * 1024, Opal::Flag=false);
+
+    /*!
+     * Spawns one worker per given placement, pinned to its' cpus with
+     * its' stack on its' node. Without placements, the pool lays out
+     * one worker per physical core the creator may run on.
+     * \param placements The placement of each worker, or null
+     * \param count The amount of placements; the most workers to
+     * lay out without placements, zero for every core
+     * \param observer The Opal::SaboteurObserver that receives callbacks
+     * from every worker
+     * \param stackSize The usable size of each worker's stack in bytes
+     * \param stealing Denotes if idle workers steal from busy ones
+     */
+
+    SaboteurPool(const Opal::Placement*, uint32_t=0, Opal::SaboteurObserver* =0, uint64_t=8 * 1024 * 1024, Opal::Flag=false);
+
+    /*!
+     * Deconstructor. Resumes any suspended worker, then terminates every
+     * worker once it has finished its' remaining execution addresses and
+     * releases it.
+     */
+
+    ~SaboteurPool();
+
+    /*!
+     * Copying a pool would share its' workers.
+     */
+
+    SaboteurPool(const SaboteurPool&)            = delete;
+    SaboteurPool& operator=(const SaboteurPool&) = delete;
+
+    /// -------
+    /// Methods
+
+    /*!
+     * Submits the given execution address to the pool. A waiting
+     * worker is preferred; if every worker is busy, the address is
+     * placed behind the work of the next worker in turn.
+     * Any number of threads may submit at once.
+     * \param executionAddress The execution address to submit
+     * \throws SaboteurPoolFullException if every worker is full.
+     */
+
+    void submit(void*);
+
+    /*!
+     * Submits the given Opal::Task to the pool, the same way an
+     * execution address is. The Opal::Task is stored in the paths of
+     * whichever worker takes it.
+     * \param task The Opal::Task to submit
+     * \throws SaboteurPoolFullException if every worker is full.
+     */
+
+    void submit(Opal::Task&&);
+
+    /*!
+     * Spawns a green task that runs the given Opal::Task on the next
+     * worker in turn. The green task stays on that worker; it's never
+     * stolen. Any number of threads may spawn at once.
+     * \param task The Opal::Task the green task runs
+     * \throws GreenTaskCreateFailureException if no green stack could be mapped.
+     */
+
+    void spawn(Opal::Task&&);
+
+    /*!
+     * Stops every worker in the pool at once and returns once they
+     * have all provably stopped. Must be invoked by the thread that
+     * created the pool.
+     * \return Opal::Nanoseconds the barrier took
+     * \throws SaboteurPoolDetachedException if a worker has a time slice.
+     * \throws SaboteurPoolSuspendFailureException if a worker didn't
+     * stop; the ones that did are continued first.
+     */
+
+    Opal::Nanoseconds suspendAll();
+
+    /*!
+     * Continues every worker stopped by suspendAll(). Must be invoked
+     * by the thread that created the pool.
+     * \return Opal::Nanoseconds it took to continue the pool
+     * \throws SaboteurPoolDetachedException if a worker has a time slice.
+     */
+
+    Opal::Nanoseconds resumeAll();
+
+    /*!
+     * Sets the cpu time every worker's running code gets before it's
+     * preempted in favor of whatever is waiting behind it; see
+     * Opal::Saboteur::setTimeSlice(). Must be invoked by the thread
+     * that created the pool. Every worker is detached from ptrace for
+     * good, even once the slice is turned off, so suspendAll(),
+     * resumeAll() and migrate() throw from then on.
+     * \param slice The time slice in nanoseconds, 0 to turn it off
+     */
+
+    void setTimeSlice(Opal::Nanoseconds);
+
+    /*!
+     * Returns the amount of workers in the pool.
+     * \return the amount of workers
+     */
+
+    uint32_t getSize();
+
+    /*!
+     * Returns the worker at the given index.
+     * \param index The index of the worker
+     * \return Reference to the worker
+     */
+
+    Opal::Saboteur& getWorker(uint32_t);
+
+    /*!
+     * Returns the amount of execution addresses the workers stole
+     * from each other.
+     * \return the amount of steals
+     */
+
+    uint64_t getSteals();
+
+    /*!
+     * Returns the amount of times a worker went looking for something
+     * to steal and came up empty.
+     * \return the amount of failed steal attempts
+     */
+
+    uint64_t getStealFailures();
+
+    /*!
+     * Returns the amount of times a worker's running code was
+     * preempted at the end of its' time slice.
+     * \return the amount of preemptions
+     */
+
+    uint64_t getPreemptions();
+
+    /*!
+     * Opens a perf_event group on every worker. Each worker attributes
+     * what it runs on its' own; read them through getWorker().
+     * \param software Denotes if context switches and page faults are counted
+     * \return Opal::Flag denoting if every worker is being counted
+     */
+
+    Opal::Flag openCounters(Opal::Flag=true);
+
+    /*!
+     * Sets every worker to record its' latency histograms.
+     */
+
+    void setHistograms();
+
+    /*!
+     * Adds the given latency histogram of every worker to the given
+     * Opal::Histogram.
+     * \param histogram The HISTOGRAM_* to aggregate
+     * \param into The Opal::Histogram to add them to
+     * \return Opal::Flag denoting if any worker records histograms
+     */
+
+    Opal::Flag getHistogram(uint32_t, Opal::Histogram&);
+
+    /*!
+     * Moves the green task the given worker is running to another one;
+     * see Opal::Saboteur::migrate. Must be invoked by the thread that
+     * created the Opal::SaboteurPool.
+     * \param from The index of the worker to move the green task off
+     * \param to The index of the worker to move it to
+     * \return Opal::Flag denoting if a green task is being moved
+     * \throws SaboteurPoolDetachedException if the worker has a time slice.
+     */
+
+    Opal::Flag migrate(uint32_t, uint32_t);
+
+#if __cpp_impl_coroutine
+
+    /// ----------
+    /// Coroutines
+
+    /*!
+     * Awaitable that moves the awaiting coroutine onto a worker of an
+     * Opal::SaboteurPool, preferring a waiting one. The coroutine's
+     * handle is submitted as is, so hopping allocates nothing.
+     */
+
+    class Schedule {
+
+        Opal::SaboteurPool& pool;
+
+    public:
+
+        explicit Schedule(Opal::SaboteurPool& pool): pool(pool) { /* Empty */ }
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+
+            pool.submit(Opal::PathDeterminant::Continuation(handle.address()));
+
+        }
+
+        void await_resume() const noexcept { /* Empty */ }
+
+    };
+
+    /*!
+     * Returns an awaitable that continues the awaiting coroutine on
+     * whichever worker the pool would hand an execution address to.
+     * \return Awaitable for co_await
+     * \throws SaboteurPoolFullException when awaited if every worker is full.
+     */
+
+    Schedule schedule() { return Schedule(*this); }
+
+#endif
+
+    /// ----------
+    /// Exceptions
+
+    /*!
+     * Exception that gets thrown when every worker's execution addresses
+     * are full
+     */
+
+    class SaboteurPoolFullException : public Opal::Exception {
+
+        Opal::StringLiteral what() const throw() {
+
+            return "Error: Every worker in the Saboteur Pool is full.";
+
+        }
+
+    };
+
+    /*!
+     * Exception that gets thrown when a ptrace based operation reaches
+     * a worker that setTimeSlice() detached from ptrace
+     */
+
+    class SaboteurPoolDetachedException : public Opal::Exception {
+
+        Opal::StringLiteral what() const throw() {
+
+            return "Error: A worker in the Saboteur Pool is detached; it has a time slice.";
+
+        }
+
+    };
+
+    /*!
+     * Exception that gets thrown when a worker couldn't be stopped
+     */
+
+    class SaboteurPoolSuspendFailureException : public Opal::Exception {
+
+        Opal::StringLiteral what() const throw() {
+
+            return "Error: A worker in the Saboteur Pool couldn't be stopped.";
+
+        }
+
+    };
+
+};
+
+#endif
@@ -0,0 +1,193 @@
+/*!
+ * \brief StackArena class
+ *
+ * Opal::StackArena declaration. Defines a pool of mmap'd stacks that
+ * are handed out to Opal::Saboteur instances. Each stack sits on top
+ * of a PROT_NONE guard region so an overflow faults instead of
+ * silently corrupting whatever lives below it. Released stacks are
+ * kept on a free list and handed out again without a system call.
+ *
+ * Each stack may be allocated with options; without commit charge,
+ * on huge pages, or with every page faulted in up front. Released
+ * stacks are only reused for the same size and options.
+ *
+ * \author Carlos L. Cuenca
+ * \version 0.1.0
+ * \date 02/07/2022
+ */
+
+#ifndef OPAL_STACK_ARENA_HPP
+#define OPAL_STACK_ARENA_HPP
+
+/// --------
+/// Includes
+
+#include<sys/mman.h>
+#include<unistd.h>
+#include<Types.hpp>
+
+namespace Opal { class StackArena; }
+
+/// --------------------------
+/// Opal::StackArena Options
+
+/*!
+ * \def STACK_NORESERVE
+ * \brief The stack is mapped without reserving swap or commit charge;
+ * a large stack only costs the pages it touches.
+ */
+
+#define STACK_NORESERVE 0x00000001
+
+/*!
+ * \def STACK_HUGE
+ * \brief The stack is rounded up to whole huge pages and aligned to
+ * them. Explicit huge pages are used when the kernel has them reserved,
+ * transparent ones otherwise.
+ */
+
+#define STACK_HUGE 0x00000002
+
+/*!
+ * \def STACK_PREFAULT
+ * \brief Every page of the stack is faulted in when it's mapped, so
+ * the thread running on it never takes a first-touch fault.
+ */
+
+#define STACK_PREFAULT 0x00000004
+
+/// -----------------
+/// Class Declaration
+
+class Opal::StackArena {
+
+    /// ---------------
+    /// Private Members
+
+private:
+
+    /*!
+     * Free list record. Lives at the top of a released stack;
+     * the page it occupies was touched when the stack was in use.
+     */
+
+    struct Stack {
+
+        Stack*      next    ; /*< The next released stack           */
+        uint64_t    size    ; /*< The usable size in bytes          */
+        uint64_t    options ; /*< The options it was mapped with    */
+
+    };
+
+    /// ----------------
+    /// Member Variables
+
+    Opal::Mutex                 mutex       ; /*< Mutex that corresponds to free list changes   */
+    Stack*                      released    ; /*< The most recently released stack              */
+    uint64_t                    guardSize   ; /*< The size of the guard region in bytes         */
+    uint64_t                    mapped      ; /*< The amount of stacks mapped                   */
+    uint64_t                    reused      ; /*< The amount of stacks handed out again         */
+
+    /// --------------
+    /// Static Methods
+
+    /*!
+     * Returns the given size rounded up to a page boundary.
+     * \param size The size in bytes
+     * \return the rounded size in bytes
+     */
+
+    static uint64_t PageAligned(uint64_t);
+
+    /*!
+     * Returns the usable size a stack with the given size and
+     * options is mapped with.
+     * \param size The size in bytes
+     * \param options The options of the stack
+     * \return the mapped size in bytes
+     */
+
+    static uint64_t MappedSize(uint64_t, uint32_t);
+
+    /*!
+     * Maps a stack of the given mapped size with the guard below it.
+     * \param size The mapped size of the stack in bytes
+     * \param options The options of the stack
+     * \return Pointer to the lowest usable address of the stack, or
+     * null if the mapping failed.
+     */
+
+    uint8_t* map(uint64_t, uint32_t);
+
+    /// --------------
+    /// Public Members
+
+public:
+
+    /*!
+     * The size of a huge page in bytes.
+     */
+
+    static const uint64_t HugePageSize = 2 * 1024 * 1024;
+
+    /// ------------
+    /// Constructors
+
+    /*!
+     * Initializes the Opal::StackArena with the given guard size.
+     * The guard size is rounded up to a page boundary.
+     * \param guardSize The size of the PROT_NONE region below each stack
+     */
+
+    StackArena(uint64_t=0);
+
+    /*!
+     * Deconstructor. Unmaps every released stack. Stacks that
+     * are still handed out are left alone.
+     */
+
+    ~StackArena();
+
+    /// -------
+    /// Methods
+
+    /*!
+     * Returns the lowest usable address of a stack with at least the
+     * given size. A released stack of the same size and options is
+     * reused if one exists, otherwise a new one is mapped.
+     * \param size The usable size of the stack in bytes
+     * \param options The STACK_* options of the stack
+     * \return Pointer to the lowest usable address of the stack, or
+     * null if the mapping failed.
+     */
+
+    void* allocate(uint64_t, uint32_t=0);
+
+    /*!
+     * Returns the given stack to the free list so it can be
+     * handed out again.
+     * \param stack The lowest usable address of the stack
+     * \param size The usable size the stack was allocated with
+     * \param options The options the stack was allocated with
+     */
+
+    void release(void*, uint64_t, uint32_t=0);
+
+    /*!
+     * Returns the amount of stacks that have been mapped.
+     * \return the amount of mapped stacks
+     */
+
+    uint64_t getMapped();
+
+    /*!
+     * Returns the amount of stacks that were handed out from
+     * the free list.
+     * \return the amount of reused stacks
+     */
+
+    uint64_t getReused();
+
+};
+
+#endif
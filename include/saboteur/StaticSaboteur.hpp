@@ -0,0 +1,173 @@
+/*!
+ * \brief StaticSaboteur class
+ *
+ * Opal::StaticSaboteur declaration. An Opal::Saboteur whose observer
+ * type is known at compile time. The observer's callbacks are called
+ * directly (and inlined) from a dispatch function generated for the
+ * observer type, and the Opal::Saboteur only calls into it for the
+ * events the observer consumes. The consumed events are the callbacks
+ * the observer declares itself, unless it narrows them down with its'
+ * own Events mask.
+ *
+ * \author Carlos L. Cuenca
+ * \version 0.1.0
+ * \date 02/07/2022
+ */
+
+#ifndef OPAL_STATIC_SABOTEUR_HPP
+#define OPAL_STATIC_SABOTEUR_HPP
+
+/// --------
+/// Includes
+
+#include<type_traits>
+#include<Types.hpp>
+#include<Saboteur.hpp>
+
+namespace Opal {
+
+    class StaticObserver;
+
+    template<typename Observer>
+    class StaticSaboteur;
+
+}
+
+/// -----------------
+/// Class Declaration
+
+/*!
+ * Base for statically dispatched observers. Every callback is empty
+ * and non-virtual; an observer declares the ones it needs.
+ */
+
+class Opal::StaticObserver {
+
+    /// --------------
+    /// Public Members
+
+public:
+
+    /// ---------
+    /// Interface
+
+    void OnCreated(void*)      { /* Empty */ }
+    void OnWaiting(void*)      { /* Empty */ }
+    void OnStarted(void*)      { /* Empty */ }
+    void OnSuspended(void*)    { /* Empty */ }
+    void OnResume(void*)       { /* Empty */ }
+    void OnSuicide(void*)      { /* Empty */ }
+    void OnTerminated(void*)   { /* Empty */ }
+
+};
+
+/// -----------------
+/// Class Declaration
+
+template<typename Observer>
+class Opal::StaticSaboteur : public Opal::Saboteur {
+
+    /// ---------------
+    /// Private Members
+
+private:
+
+    // Omit from documentation
+    // A callback the observer didn't declare is still the base's
+    #define Declares(callback) \
+        (!std::is_same<decltype(&Observer::callback), void (Opal::StaticObserver::*)(void*)>::value)
+
+    /*!
+     * The events the observer declared a callback for.
+     */
+
+    static constexpr Opal::EventMask Declared =
+        (Declares(OnCreated)    ? ON_CREATED    : 0) | (Declares(OnWaiting)    ? ON_WAITING    : 0) |
+        (Declares(OnStarted)    ? ON_STARTED    : 0) | (Declares(OnSuspended)  ? ON_SUSPENDED  : 0) |
+        (Declares(OnResume)     ? ON_RESUME     : 0) | (Declares(OnSuicide)    ? ON_SUICIDE    : 0) |
+        (Declares(OnTerminated) ? ON_TERMINATED : 0);
+
+    #undef Declares
+
+    /*!
+     * Returns the observer's own Events mask.
+     */
+
+    template<typename Type>
+    static constexpr Opal::EventMask MaskOf(decltype(Type::Events)*) { return Type::Events; }
+
+    /*!
+     * The observer doesn't narrow anything down.
+     */
+
+    template<typename Type>
+    static constexpr Opal::EventMask MaskOf(...) { return ON_ALL; }
+
+    /*!
+     * Notifies the observer of the given Opal::State. Callbacks
+     * outside of the Events mask aren't generated.
+     * \param observer The observer
+     * \param thread The Opal::Saboteur that transitioned
+     * \param state The Opal::State transitioned to
+     */
+
+    static void Dispatch(void* observer, void* thread, Opal::State state) {
+
+        Observer* target = static_cast<Observer*>(observer);
+
+        switch(state) {
+
+            case CREATED    : if constexpr((Events & ON_CREATED)    != 0) target->OnCreated(thread)   ; break;
+
+            case WAITING    : if constexpr((Events & ON_WAITING)    != 0) target->OnWaiting(thread)   ; break;
+
+            case STARTED    : if constexpr((Events & ON_STARTED)    != 0) target->OnStarted(thread)   ; break;
+
+            case SUSPENDED  : if constexpr((Events & ON_SUSPENDED)  != 0) target->OnSuspended(thread) ; break;
+
+            case RESUMING   : if constexpr((Events & ON_RESUME)     != 0) target->OnResume(thread)    ; break;
+
+            case SUICIDE    : if constexpr((Events & ON_SUICIDE)    != 0) target->OnSuicide(thread)   ; break;
+
+            case TERMINATED : if constexpr((Events & ON_TERMINATED) != 0) target->OnTerminated(thread); break;
+
+            default: break;
+
+        }
+
+    }
+
+    /// --------------
+    /// Public Members
+
+public:
+
+    /*!
+     * The events the observer is notified of.
+     */
+
+    static constexpr Opal::EventMask Events = Declared & MaskOf<Observer>(0);
+
+    /// ------------
+    /// Constructors
+
+    /*!
+     * Primary Constructor. Initializes the Opal::StaticSaboteur
+     * with the given resume address and observer.
+     * \param address The address to initialize the Opal::StaticSaboteur with.
+     * \param observer The observer that receives callbacks
+     * \param stackSize The usable size of the stack in bytes
+     */
+
+    template<typename Address>
+    StaticSaboteur(Address address, Observer* observer, uint64_t stackSize=8 * 1024 * 1024):
+    Opal::Saboteur(address, static_cast<void*>(observer), Events ? &Dispatch : 0, Events, stackSize) {
+
+        static_assert(std::is_base_of<Opal::StaticObserver, Observer>::value,
+                      "Static observers derive from Opal::StaticObserver");
+
+    }
+
+};
+
+#endif
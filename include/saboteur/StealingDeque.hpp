@@ -0,0 +1,118 @@
+/*!
+ * \brief StealingDeque class
+ *
+ * Opal::StealingDeque declaration. A bounded Chase-Lev work-stealing
+ * deque of execution addresses. The owning Opal::Saboteur pushes and
+ * pops at the bottom; any number of siblings steal from the top
+ * without acquiring a lock. Only the owner may push or pop.
+ *
+ * \author Carlos L. Cuenca
+ * \version 0.1.0
+ * \date 02/07/2022
+ */
+
+#ifndef OPAL_STEALING_DEQUE_HPP
+#define OPAL_STEALING_DEQUE_HPP
+
+/// --------
+/// Includes
+
+#include<Types.hpp>
+
+namespace Opal { class StealingDeque; }
+
+/// -----------------
+/// Class Declaration
+
+class Opal::StealingDeque {
+
+    /// --------------
+    /// Public Members
+
+public:
+
+    /*!
+     * The amount of execution addresses the Opal::StealingDeque
+     * holds. Must be a power of two.
+     */
+
+    static const int64_t Capacity = 256;
+
+    /*!
+     * The most execution addresses the owner moves to the
+     * Opal::StealingDeque at once. Anything pushed to the owner
+     * afterwards waits behind at most this many.
+     */
+
+    static const int64_t Batch = 32;
+
+    /// ---------------
+    /// Private Members
+
+private:
+
+    /// ----------------
+    /// Member Variables
+
+    Opal::Atomic<int64_t>           top                 ; /*< The position thieves steal from               */
+    Opal::Atomic<int64_t>           bottom              ; /*< The position the owner pushes to              */
+    Opal::Atomic<void*>             addresses[Capacity] ; /*< The execution addresses                       */
+    Opal::Atomic<Opal::Nanoseconds> queued[Capacity]    ; /*< When each address was queued, 0 if unknown    */
+
+    /// --------------
+    /// Public Members
+
+public:
+
+    /// ------------
+    /// Constructors
+
+    /*!
+     * Default Constructor. Initializes an empty Opal::StealingDeque.
+     */
+
+    StealingDeque();
+
+    /// -------
+    /// Methods
+
+    /*!
+     * Pushes the given execution address at the bottom. Owner only.
+     * \param address The execution address
+     * \param queued When the address was queued, zero if unknown
+     * \return Opal::Flag denoting if the address was pushed; false if
+     * the Opal::StealingDeque is full.
+     */
+
+    Opal::Flag push(void*, Opal::Nanoseconds =0);
+
+    /*!
+     * Removes and returns the execution address at the bottom. Owner only.
+     * \param queued Where the time the address was queued goes, if anywhere
+     * \return the execution address, or null if there is none.
+     */
+
+    void* pop(Opal::Nanoseconds* =0);
+
+    /*!
+     * Removes and returns the execution address at the top. Any
+     * thread may steal, the owner included; that's how it takes its'
+     * oldest address.
+     * \param queued Where the time the address was queued goes, if anywhere
+     * \return the execution address, or null if there is none or
+     * another thread got to it first.
+     */
+
+    void* steal(Opal::Nanoseconds* =0);
+
+    /*!
+     * Returns the amount of execution addresses held. The value is
+     * exact for the owner and a snapshot for everyone else.
+     * \return the amount of execution addresses
+     */
+
+    int64_t getSize();
+
+};
+
+#endif
@@ -0,0 +1,225 @@
+/*!
+ * \brief Supervisor class
+ *
+ * Opal::Supervisor declaration. Watches any amount of Opal::Saboteurs
+ * for exits and stops through a single epoll set, so a whole fleet is
+ * supervised by one thread that sleeps until something happens. Exits
+ * come from each Opal::Saboteur's pidfd. Stops come from the SIGCHLD
+ * their tracer is sent, read through a signalfd, and are looked up by
+ * thread id.
+ *
+ * Nothing is reaped; stops and exits are peeked at and left for the
+ * tracer, which still suspends, resumes and joins its' Opal::Saboteurs
+ * as it always does.
+ *
+ * \author Carlos L. Cuenca
+ * \version 0.1.0
+ * \date 02/07/2022
+ */
+
+#ifndef OPAL_SUPERVISOR_HPP
+#define OPAL_SUPERVISOR_HPP
+
+/// --------
+/// Includes
+
+#include<sys/types.h>
+#include<Types.hpp>
+
+namespace Opal { class Supervisor; class Saboteur; }
+
+/// ----------------------------
+/// Opal::Supervisor Event Kinds
+
+/*!
+ * \def SUPERVISOR_EXITED
+ * \brief The Opal::Saboteur's thread exited. The status is its' exit
+ * code, or the signal that killed it. An exited Opal::Saboteur is no
+ * longer watched.
+ */
+
+#define SUPERVISOR_EXITED 0x00000001
+
+/*!
+ * \def SUPERVISOR_STOPPED
+ * \brief The Opal::Saboteur's thread stopped and the stop hasn't been
+ * reaped. The status is the ptrace stop status; a suspension reads
+ * PTRACE_EVENT_STOP in its' upper byte, a signal that stopped it
+ * reads as the signal alone.
+ */
+
+#define SUPERVISOR_STOPPED 0x00000002
+
+/// -----------------
+/// Class Declaration
+
+class Opal::Supervisor {
+
+    /// --------------
+    /// Public Members
+
+public:
+
+    /*!
+     * The amount of Opal::Saboteurs watched by default.
+     */
+
+    static const uint32_t DefaultCapacity = 4096;
+
+    /*!
+     * Something that happened to a watched Opal::Saboteur.
+     */
+
+    struct Event {
+
+        Opal::Saboteur* saboteur    ; /*< The Opal::Saboteur it happened to  */
+        uint32_t        kind        ; /*< The SUPERVISOR_* that happened      */
+        int32_t         status      ; /*< What it came with                   */
+
+    };
+
+    /// ---------------
+    /// Private Members
+
+private:
+
+    /*!
+     * A watched Opal::Saboteur, found by its' thread id.
+     */
+
+    struct Slot {
+
+        Opal::Atomic<pid_t>             threadID    ; /*< The thread id, 0 if never used, -1 if let go */
+        Opal::Atomic<Opal::Saboteur*>   saboteur    ; /*< The Opal::Saboteur, null while claimed        */
+
+    };
+
+    /// ----------------
+    /// Member Variables
+
+    int32_t                 epoll       ; /*< The epoll set                                     */
+    int32_t                 signals     ; /*< The signalfd SIGCHLD is read from                 */
+    uint32_t                capacity    ; /*< The amount of slots; a power of two               */
+    Slot*                   slots       ; /*< The watched Opal::Saboteurs by thread id          */
+    Opal::Atomic<uint32_t>  watched     ; /*< The amount of Opal::Saboteurs being watched       */
+
+    /// -------
+    /// Methods
+
+    /*!
+     * Returns the slot of the given thread id.
+     * \param threadID The thread id
+     * \return Pointer to the slot, or null if it isn't watched
+     */
+
+    Slot* slotOf(pid_t);
+
+    /*!
+     * Stops watching the given slot's Opal::Saboteur, unless somebody
+     * else got to it first.
+     * \param slot The slot
+     * \param saboteur The Opal::Saboteur in it
+     * \return Opal::Flag denoting if it was let go here
+     */
+
+    Opal::Flag release(Slot*, Opal::Saboteur*);
+
+    /// --------------
+    /// Public Members
+
+public:
+
+    /// ------------
+    /// Constructors
+
+    /*!
+     * Initializes an Opal::Supervisor that watches up to the given
+     * amount of Opal::Saboteurs at once. Blocks SIGCHLD on the invoking
+     * thread.
+     * \param capacity The most Opal::Saboteurs watched at once
+     * \throws SupervisorCreateFailureException if the epoll set or the
+     * signalfd couldn't be created.
+     */
+
+    Supervisor(uint32_t=DefaultCapacity);
+
+    /*!
+     * Deconstructor. Closes the epoll set and the signalfd.
+     */
+
+    ~Supervisor();
+
+    /*!
+     * The descriptors belong to a single Opal::Supervisor.
+     */
+
+    Supervisor(const Supervisor&)            = delete;
+    Supervisor& operator=(const Supervisor&) = delete;
+
+    /// -------
+    /// Methods
+
+    /*!
+     * Starts watching the given Opal::Saboteur. Any thread may watch.
+     * \param saboteur The Opal::Saboteur to watch
+     * \return Opal::Flag denoting if it's being watched
+     */
+
+    Opal::Flag watch(Opal::Saboteur*);
+
+    /*!
+     * Stops watching the given Opal::Saboteur. Must be invoked before
+     * a watched Opal::Saboteur is destroyed, unless it has exited.
+     * \param saboteur The Opal::Saboteur to stop watching
+     * \return Opal::Flag denoting if it was being watched
+     */
+
+    Opal::Flag unwatch(Opal::Saboteur*);
+
+    /*!
+     * Waits until something happens to the watched Opal::Saboteurs, or
+     * until the timeout runs out, and collects what happened. Only
+     * one thread may wait at a time.
+     * \param events The array to fill
+     * \param capacity The capacity of the array
+     * \param timeout The most milliseconds to wait, -1 to wait indefinitely
+     * \return the amount of events written
+     */
+
+    uint32_t wait(Event*, uint32_t, int32_t=-1);
+
+    /*!
+     * Returns the amount of Opal::Saboteurs being watched.
+     * \return the amount of watched Opal::Saboteurs
+     */
+
+    uint32_t getWatched();
+
+    /*!
+     * Returns the epoll set, so the Opal::Supervisor can be waited on
+     * from another event loop.
+     * \return the epoll descriptor
+     */
+
+    int32_t getDescriptor();
+
+    /// ----------
+    /// Exceptions
+
+    /*!
+     * Exception that gets thrown when the descriptors can't be created.
+     */
+
+    class SupervisorCreateFailureException : public Opal::Exception {
+
+        Opal::StringLiteral what() const throw() {
+
+            return "Error: Supervisor creation failed.";
+
+        }
+
+    };
+
+};
+
+#endif
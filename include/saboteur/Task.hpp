@@ -0,0 +1,233 @@
+/*!
+ * \brief Task class
+ *
+ * Opal::Task declaration. Holds any callable that takes no arguments,
+ * along with whatever it captured, so work handed to an Opal::Saboteur
+ * can carry its' own data. Closures that fit in the Opal::Task are
+ * stored inline and never touch the heap; larger ones are moved to
+ * the heap once, when the Opal::Task is constructed. An Opal::Task
+ * can be moved but not copied, and is invoked at most once.
+ *
+ * \author Carlos L. Cuenca
+ * \version 0.1.0
+ * \date 02/07/2022
+ */
+
+#ifndef OPAL_TASK_HPP
+#define OPAL_TASK_HPP
+
+/// --------
+/// Includes
+
+#include<new>
+#include<type_traits>
+#include<utility>
+#include<Types.hpp>
+
+namespace Opal { class Task; }
+
+/// -----------------
+/// Class Declaration
+
+class Opal::Task {
+
+    /// --------------
+    /// Public Members
+
+public:
+
+    /*!
+     * The largest closure, in bytes, an Opal::Task stores inline.
+     */
+
+    static const uint64_t InlineSize = 48;
+
+    /// ---------------
+    /// Private Members
+
+private:
+
+    /*!
+     * Denotes a closure that's stored inline; it has to fit, be
+     * aligned no stricter than the storage, and move without throwing.
+     */
+
+    template<typename Callable>
+    static constexpr Opal::Flag IsInline =
+        sizeof(Callable) <= InlineSize && alignof(Callable) <= 16 && std::is_nothrow_move_constructible<Callable>::value;
+
+    /// ----------------
+    /// Member Variables
+
+    alignas(16) uint8_t storage[InlineSize]                     ; /*< The closure, or a pointer to it   */
+    void (*invoke)(void*)                                       ; /*< Invokes the closure               */
+    void (*relocate)(void*, void*)                              ; /*< Moves the closure and destroys it */
+
+    /// --------------
+    /// Static Methods
+
+    /*!
+     * Invokes the closure stored in the given storage.
+     * \param storage The storage of an Opal::Task
+     */
+
+    template<typename Callable>
+    static void Invoke(void* storage) {
+
+        if constexpr (IsInline<Callable>) (*static_cast<Callable*>(storage))();
+
+        else (**static_cast<Callable**>(storage))();
+
+    }
+
+    /*!
+     * Moves the closure stored in the given storage to the given
+     * destination and destroys what's left behind. A null destination
+     * only destroys it.
+     * \param storage The storage of an Opal::Task
+     * \param destination The storage of another Opal::Task, or null
+     */
+
+    template<typename Callable>
+    static void Relocate(void* storage, void* destination) {
+
+        if constexpr (IsInline<Callable>) {
+
+            Callable* callable = static_cast<Callable*>(storage);
+
+            if(destination) new(destination) Callable(std::move(*callable));
+
+            callable->~Callable();
+
+        }
+
+        // Only the pointer moves
+        else if(destination) *static_cast<Callable**>(destination) = *static_cast<Callable**>(storage);
+
+        else delete *static_cast<Callable**>(storage);
+
+    }
+
+    /// --------------
+    /// Public Members
+
+public:
+
+    /// ------------
+    /// Constructors
+
+    /*!
+     * Default Constructor. Initializes an empty Opal::Task.
+     */
+
+    Task(): storage(), invoke(0), relocate(0) { /* Empty */ }
+
+    /*!
+     * Initializes the Opal::Task with the given callable.
+     * \param callable Any callable that takes no arguments
+     */
+
+    template<typename Callable, typename Decayed = typename std::decay<Callable>::type,
+             typename = typename std::enable_if<!std::is_same<Decayed, Opal::Task>::value &&
+                                                std::is_invocable<Decayed&>::value>::type>
+    Task(Callable&& callable): storage(), invoke(&Invoke<Decayed>), relocate(&Relocate<Decayed>) {
+
+        if constexpr (IsInline<Decayed>) new(storage) Decayed(std::forward<Callable>(callable));
+
+        else *reinterpret_cast<Decayed**>(storage) = new Decayed(std::forward<Callable>(callable));
+
+    }
+
+    /*!
+     * Move Constructor. Takes the closure of the given Opal::Task,
+     * leaving it empty.
+     * \param task The Opal::Task to move from
+     */
+
+    Task(Task&& task): storage(), invoke(task.invoke), relocate(task.relocate) {
+
+        if(relocate) relocate(task.storage, storage);
+
+        task.invoke   = 0;
+        task.relocate = 0;
+
+    }
+
+    /*!
+     * Move Assignment. Destroys the closure of the Opal::Task and
+     * takes the closure of the given one, leaving it empty.
+     * \param task The Opal::Task to move from
+     * \return Reference to the Opal::Task
+     */
+
+    Task& operator=(Task&& task) {
+
+        if(this == &task) return *this;
+
+        reset();
+
+        invoke   = task.invoke  ;
+        relocate = task.relocate;
+
+        if(relocate) relocate(task.storage, storage);
+
+        task.invoke   = 0;
+        task.relocate = 0;
+
+        return *this;
+
+    }
+
+    /*!
+     * Closures might not be copyable, and tasks run once.
+     */
+
+    Task(const Task&)            = delete;
+    Task& operator=(const Task&) = delete;
+
+    /*!
+     * Deconstructor. Destroys the closure, if any.
+     */
+
+    ~Task() { reset(); }
+
+    /// -------
+    /// Methods
+
+    /*!
+     * Invokes the closure. Invoking an empty Opal::Task does nothing.
+     */
+
+    void operator()() { if(invoke) invoke(storage); }
+
+    /*!
+     * Destroys the closure, leaving the Opal::Task empty.
+     */
+
+    void reset() {
+
+        if(relocate) relocate(storage, 0);
+
+        invoke   = 0;
+        relocate = 0;
+
+    }
+
+    /*!
+     * Returns a flag denoting if the Opal::Task holds no closure.
+     * \return Opal::Flag denoting if the Opal::Task is empty
+     */
+
+    Opal::Flag isEmpty() const { return !invoke; }
+
+    /*!
+     * Returns what identifies the kind of closure the Opal::Task holds;
+     * every Opal::Task made from the same type of callable shares it.
+     * \return the source, or null if the Opal::Task is empty
+     */
+
+    void* getSource() const { return reinterpret_cast<void*>(invoke); }
+
+};
+
+#endif
@@ -0,0 +1,273 @@
+/*!
+ * \brief Opal tracing
+ *
+ * Compile-time removable tracing for the Opal::Saboteur lifecycle.
+ * The trace level is selected with OPAL_TRACE_LEVEL (see the makefile's
+ * TRACELEVEL). Every trace point above the selected level expands to
+ * nothing, arguments included. Enabled trace points append a binary
+ * record to the Opal::TraceRing of the Opal::Saboteur they concern;
+ * nothing is formatted, locked or flushed on the traced path.
+ *
+ * \author Carlos L. Cuenca
+ * \version 0.1.0
+ * \date 02/07/2022
+ */
+
+#ifndef OPAL_TRACE_HPP
+#define OPAL_TRACE_HPP
+
+/// --------
+/// Includes
+
+#include<x86intrin.h>
+#include<Types.hpp>
+
+namespace Opal { class TraceRing; }
+
+/// ------------
+/// Trace Levels
+
+/*!
+ * \def OPAL_TRACE_NONE
+ * \brief Tracing is compiled out entirely.
+ */
+
+#define OPAL_TRACE_NONE 0
+
+/*!
+ * \def OPAL_TRACE_ERROR
+ * \brief Failed system calls are traced.
+ */
+
+#define OPAL_TRACE_ERROR 1
+
+/*!
+ * \def OPAL_TRACE_STATE
+ * \brief State transitions and lifecycle operations are traced.
+ */
+
+#define OPAL_TRACE_STATE 2
+
+/*!
+ * \def OPAL_TRACE_VERBOSE
+ * \brief Every intermediate step is traced.
+ */
+
+#define OPAL_TRACE_VERBOSE 3
+
+#ifndef OPAL_TRACE_LEVEL
+#define OPAL_TRACE_LEVEL OPAL_TRACE_NONE
+#endif
+
+/// ------------
+/// Trace Events
+
+#define TRACE_ERROR         0x0001  /*< value: errno of the failed system call  */
+#define TRACE_STATE         0x0002  /*< value: the state transitioned to        */
+#define TRACE_CREATE        0x0003  /*< value: the stack address                */
+#define TRACE_CLONE         0x0004  /*< value: the process id of the clone      */
+#define TRACE_SEIZE         0x0005  /*< value: the process id being traced      */
+#define TRACE_EXECUTE       0x0006  /*< value: the execution address            */
+#define TRACE_PUSH          0x0007  /*< value: the pushed execution address     */
+#define TRACE_REGISTERS     0x0008  /*< value: the thread id                    */
+#define TRACE_WAITING       0x0009  /*< value: the thread id                    */
+#define TRACE_TERMINATING   0x000a  /*< value: the thread id                    */
+#define TRACE_DESTROY       0x000b  /*< value: the thread id                    */
+
+/// ------------
+/// Trace Points
+
+/*!
+ * \def TraceError(ring, event, value)
+ * \brief Records an error in the given Opal::TraceRing.
+ */
+
+#if OPAL_TRACE_LEVEL >= OPAL_TRACE_ERROR
+#define TraceError(ring, event, value) (ring).record(event, (uint64_t)(value))
+#else
+#define TraceError(ring, event, value) ((void) 0)
+#endif
+
+/*!
+ * \def TraceState(ring, event, value)
+ * \brief Records a lifecycle event in the given Opal::TraceRing.
+ */
+
+#if OPAL_TRACE_LEVEL >= OPAL_TRACE_STATE
+#define TraceState(ring, event, value) (ring).record(event, (uint64_t)(value))
+#else
+#define TraceState(ring, event, value) ((void) 0)
+#endif
+
+/*!
+ * \def TraceVerbose(ring, event, value)
+ * \brief Records an intermediate step in the given Opal::TraceRing.
+ */
+
+#if OPAL_TRACE_LEVEL >= OPAL_TRACE_VERBOSE
+#define TraceVerbose(ring, event, value) (ring).record(event, (uint64_t)(value))
+#else
+#define TraceVerbose(ring, event, value) ((void) 0)
+#endif
+
+/// -----------------
+/// Class Declaration
+
+class Opal::TraceRing {
+
+    /// --------------
+    /// Public Members
+
+public:
+
+    /*!
+     * Binary trace record. The timestamp is in time stamp
+     * counter ticks.
+     */
+
+    struct Record {
+
+        uint64_t    timestamp   ; /*< The time stamp counter at the trace point     */
+        uint64_t    value       ; /*< The event specific value                      */
+        uint32_t    event       ; /*< The event that was traced                     */
+
+    };
+
+    /*!
+     * The amount of records the Opal::TraceRing retains.
+     * Must be a power of two.
+     */
+
+    static const uint64_t Capacity = 256;
+
+    /// ---------------
+    /// Private Members
+
+private:
+
+    /*!
+     * A record slot. The sequence is zero while the slot is being
+     * written and one past the record's index once it's complete.
+     */
+
+    struct Slot {
+
+        Opal::Atomic<uint64_t>  sequence    ;
+        Opal::Atomic<uint64_t>  timestamp   ;
+        Opal::Atomic<uint64_t>  value       ;
+        Opal::Atomic<uint32_t>  event       ;
+
+    };
+
+    /// ----------------
+    /// Member Variables
+
+    Opal::Atomic<uint64_t>  head                ; /*< The index of the next record to write     */
+    Slot                    slots[Capacity]     ; /*< The retained records                      */
+
+    /// --------------
+    /// Public Members
+
+public:
+
+    /// ------------
+    /// Constructors
+
+    /*!
+     * Default Constructor. Initializes an empty Opal::TraceRing.
+     */
+
+    TraceRing(): head(0), slots() { /* Empty */ }
+
+    /// -------
+    /// Methods
+
+    /*!
+     * Appends a record to the Opal::TraceRing, overwriting the oldest
+     * record once it's full. Any number of threads may record at once.
+     * \param event The event that was traced
+     * \param value The event specific value
+     */
+
+    void record(uint32_t, uint64_t);
+
+    /*!
+     * Copies up to the given amount of the most recent records into the
+     * given buffer, oldest first. Records that are overwritten while
+     * being copied are skipped.
+     * \param records The buffer to copy into
+     * \param count The capacity of the buffer
+     * \return the amount of records copied
+     */
+
+    uint64_t read(Record*, uint64_t);
+
+};
+
+/// ---------------
+/// Inline Methods
+
+/*!
+ * Appends a record to the Opal::TraceRing, overwriting the oldest
+ * record once it's full. Any number of threads may record at once.
+ * \param event The event that was traced
+ * \param value The event specific value
+ */
+
+inline void Opal::TraceRing::record(uint32_t event, uint64_t value) {
+
+    uint64_t index = head.fetch_add(1, std::memory_order_relaxed);
+    Slot&    slot  = slots[index & (Capacity - 1)];
+
+    // Readers skip the slot while we're in it
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.timestamp.store(__rdtsc(), std::memory_order_relaxed);
+    slot.value.store(value, std::memory_order_relaxed);
+    slot.event.store(event, std::memory_order_relaxed);
+
+    slot.sequence.store(index + 1, std::memory_order_release);
+
+}
+
+/*!
+ * Copies up to the given amount of the most recent records into the
+ * given buffer, oldest first. Records that are overwritten while
+ * being copied are skipped.
+ * \param records The buffer to copy into
+ * \param count The capacity of the buffer
+ * \return the amount of records copied
+ */
+
+inline uint64_t Opal::TraceRing::read(Opal::TraceRing::Record* records, uint64_t count) {
+
+    uint64_t end    = head.load(std::memory_order_acquire);
+    uint64_t start  = end > Capacity ? end - Capacity : 0;
+    uint64_t copied = 0;
+
+    if(end - start > count) start = end - count;
+
+    for(uint64_t index = start; index < end; index++) {
+
+        Slot&    slot     = slots[index & (Capacity - 1)];
+        uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+
+        Record record = { slot.timestamp.load(std::memory_order_relaxed),
+                          slot.value.load(std::memory_order_relaxed),
+                          slot.event.load(std::memory_order_relaxed) };
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        // Skip the record if it was incomplete or overwritten
+        if(sequence != index + 1 || slot.sequence.load(std::memory_order_relaxed) != sequence) continue;
+
+        records[copied++] = record;
+
+    }
+
+    return copied;
+
+}
+
+#endif
@@ -184,6 +184,9 @@ Lifecycle:
     ;; ----------------------
     ;; Process Stack Creation
 
+    mov rax, qword[rbx + 16]                ; Load the stack the runtime handed us (if any)
+    test rax, rax                           ; Check if we have one
+    jnz stack_ready                         ; We do; no system call required
     xor rdi, rdi                            ; Clear address argument; we want a new one
     mov rsi, PAGE_SIZE                      ; Load the page size
     xor rdx, rdx                            ; Clear the flag argument
@@ -196,11 +199,16 @@ Lifecycle:
     mov r9 , 0                              ; Clear the offset
     mov rax, MMAP                           ; Set the system call number
     syscall                                 ; Invoke it
+    mov qword[rbx + 16], rax                ; Set the stack address member in our Saboteur
+    mov qword[rbx + 24], PAGE_SIZE          ; Set the stack size member in our Saboteur
 
     ;; ---------------------
     ;; Setup the child stack
 
-    mov qword[rbx + 16], rax                ; Set the stack address member in our Saboteur
+stack_ready:
+
+    add rax            , qword[rbx + 24]    ; Point to the top of the stack; it grows down
+    sub rax            , 24                 ; Reserve the delimiter, thread handle & observer
     mov qword[rax]     , 0                  ; Delimit the stack
     add rax            , 8                  ; Create some space for our thread handle (we're upside down)
     mov qword[rax]     , rbx                ; Load the thread handle onto the stack
@@ -231,6 +239,7 @@ Lifecycle:
     xor r8 , r8                             ; Clear TLS (create new)
     mov rax, CLONE                          ; Load the system call number
     syscall                                 ; DUALITY
+    test rax, rax                           ; The system call doesn't set the flags
     jl clone_failure                        ; We failed, go handle the error
     jz thread_execute                       ; The system call returned 0, we're the child
     mov qword[rbx], rax                     ; Load the thread id
@@ -255,6 +264,7 @@ Lifecycle:
     mov rdi, qword[rbx]                     ; Set the process id (the thread we just created)
     mov rax, _WAIT                          ; Set the system call number
     syscall                                 ; Invoke the system call
+    pop  rbx                                ; Restore the register
     ret                                     ; Return to the call site
 
     ;; ---------------
@@ -284,9 +294,9 @@ clone_failure:
 
     push rax                                ; Save the error code from clone
     mov  rax, WRITE                         ; Load the write system call number
-    mov  rbx, STDOUT                        ; Load the file descriptor, stdout
-    mov  rcx, NO_STACK_ADDRESS              ; Load the address of the error message
-    mov  rdx, NO_STACK_ADDRESS_LENGTH       ; Load the message length
+    mov  rdi, STDOUT                        ; Load the file descriptor, stdout
+    mov  rsi, CLONE_FAILED                  ; Load the address of the error message
+    mov  rdx, CLONE_FAILED_LENGTH           ; Load the message length
     syscall                                 ; Print the error message
     pop  rax                                ; Retrieve the error code
     pop  rbx                                ; Restore the register
@@ -300,8 +310,7 @@ thread_execute:
     ;; -----------
     ;; Child setup
 
-    mov  rbx, rbp                           ; Load the thread handle
-    add  rbx, 16                            ; Point to the thread handle. Not sure why it's offset but ok
+    mov  rbx, qword[rsp + 8]                ; Load the thread handle we left above the delimiter
 
     ;; ----------------
     ;; Set syscall stop
@@ -332,12 +341,13 @@ thread_execute:
     ;; ---------------
     ;; Create Dispatch
 
-    mov  rax, qword[rbx + 8]                 ; Load the thread state
-    xor  rax, rax                            ; Clear state
-    or   rax, CREATED                        ; Set the state as created
-    mov  rax, qword[rsp + 32]                ; Load the observer
-    mov  rax, qword[rax + 8]                 ; Retrieve OnCreated THE OBSERVER HAS A VTABLE
-    mov  rdi, rbx                            ; Load the thread handle as the first argument
+    mov  rdi, qword[rsp + 16]                ; Load the observer
+    test rdi, rdi                            ; Check if we have one
+    jz   thread_finish                       ; Nobody to notify
+    mov  rax, qword[rdi]                     ; Load the observer's vtable
+    mov  rax, qword[rax + 16]                ; Retrieve OnCreated; it follows both destructors
+    mov  rsi, rbx                            ; Load the thread handle as the argument
+    sub  rsp, 8                              ; Align the stack for the call
     call rax                                 ; Notify the observer of the state mutation
 
     ;; ----------------
@@ -351,6 +361,6 @@ thread_lifecycle:
 
 thread_finish:
 
-    mov rdi, rax                            ; Set the return code as the first argument
+    xor rdi, rdi                            ; Set the return code as the first argument
     mov rax, EXIT                           ; Set the system call number
     syscall                                 ; Invoke the system call
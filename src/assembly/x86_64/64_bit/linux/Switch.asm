@@ -0,0 +1,96 @@
+;; Green Task Context Switch. Saves the callee-saved state of the running
+;; context on its' own stack, stores the resulting stack pointer, and
+;; continues the context that was saved at the given stack pointer. Only
+;; the state the psABI requires a callee to preserve is switched; the
+;; caller has already spilled everything else.
+;;
+;; Version 0.1.0
+;;
+;; THIS PROGRAM WAS BUILT WITH YASM; X86-64 (64-bit linux)
+;;
+;; Method Stubs:
+;;
+;; void SwitchContext(void** save, void* load);
+;; void ContextStart();
+;;
+;; save                 - At least 8 Bytes
+;; load                 - At least 8 Bytes
+;;
+;; Per the standard calling convention (x86-64 ABI) The parameters are set as
+;; expected by the kernel:
+;;
+;; rdi    : save (where the stack pointer of the running context goes)
+;; rsi    : load (the stack pointer of the context to continue)
+;; rdx    : n/a
+;; rcx    : n/a
+;; r8     : n/a
+;; r9     : n/a
+;; %rsp+8 : n/a
+;;
+;; Saved Context (from the saved stack pointer up):
+;;
+;; +0   : mxcsr          - 4 Bytes
+;; +4   : x87 control    - 4 Bytes (2 used)
+;; +8   : r15
+;; +16  : r14
+;; +24  : r13
+;; +32  : r12
+;; +40  : rbx
+;; +48  : rbp
+;; +56  : return address
+;;
+;; A context that has never run is made to look like one that switched
+;; out, with ContextStart as its' return address, the argument in r12
+;; and the entry function in r13.
+;;
+;; TODO: We want an .eh_frame
+
+;; -----------
+;; Switch Start
+
+section .text
+global SwitchContext
+SwitchContext:
+
+    ;; ---------------------
+    ;; Register Preservation
+
+    push rbp                                ; Save the callee-saved registers per the psABI
+    push rbx
+    push r12
+    push r13
+    push r14
+    push r15
+    sub  rsp, 8                             ; Make room for the control words
+    stmxcsr dword[rsp]                      ; Save the SSE control and status
+    fnstcw  word[rsp + 4]                   ; Save the x87 control word
+
+    ;; -------------
+    ;; Stack Switch
+
+    mov qword[rdi], rsp                     ; Hand the running context's stack pointer back
+    mov rsp, rsi                            ; Continue on the other context's stack
+
+    ;; -------------------
+    ;; Register Restoration
+
+    ldmxcsr dword[rsp]                      ; Restore the SSE control and status
+    fldcw   word[rsp + 4]                   ; Restore the x87 control word
+    add  rsp, 8                             ; Drop the control words
+    pop  r15                                ; Restore the callee-saved registers
+    pop  r14
+    pop  r13
+    pop  r12
+    pop  rbx
+    pop  rbp
+    ret                                     ; Continue where the other context switched out
+
+;; -------------
+;; Context Start
+
+global ContextStart
+ContextStart:
+
+    mov  rdi, r12                           ; Load the argument
+    call r13                                ; Invoke the entry function; it never returns
+    ud2                                     ; If it does, fault rather than run off the stack
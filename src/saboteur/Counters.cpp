@@ -0,0 +1,356 @@
+/*!
+ * Opal::Counters implementation
+ *
+ * \author: Carlos L. Cuenca
+ */
+
+#include<cstring>
+#include<sys/mman.h>
+#include<sys/syscall.h>
+#include<unistd.h>
+#include<Counters.hpp>
+
+/// -----------------
+/// Macro Definitions
+
+// Omit from documentation
+// Spreads the given source over the given amount of slots; sources
+// are at least 16-byte aligned, so the low bits say nothing.
+#define SlotIndex(source, capacity) \
+    static_cast<uint32_t>(((reinterpret_cast<uint64_t>(source) >> 4) * 0x9E3779B97F4A7C15ULL) >> (64 - __builtin_ctz(capacity)))
+
+/// ---------------------
+/// Static Initialization
+
+/*!
+ * The events of the group in Sample order, whether each is a hardware
+ * event, and so a candidate for rdpmc.
+ */
+
+static const struct { uint32_t type; uint64_t config; Opal::Flag hardware; } Definitions[Opal::Counters::Events] = {
+
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES,         true    },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS,       true    },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES,       true    },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES,   false   },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS,        false   }
+
+};
+
+/// ------------
+/// Constructors
+
+/*!
+ * Default Constructor. Initializes closed Opal::Counters
+ * with no attributions.
+ */
+
+Opal::Counters::Counters(): descriptors(), positions(), pages(), members(0), direct(false), slots(), rest() {
+
+    for(uint32_t event = 0; event < Events; event++) descriptors[event] = -1;
+
+}
+
+/*!
+ * Deconstructor. Closes the group.
+ */
+
+Opal::Counters::~Counters() { close(); }
+
+/// ---------------
+/// Private Methods
+
+/*!
+ * Reads the given hardware event with rdpmc, following the sequence
+ * count of its' mapped page; the kernel bumps it whenever the event
+ * moves between counters. Must be invoked by the counted thread.
+ * \param event The event
+ * \param value Where the value goes
+ * \return Opal::Flag denoting if the event could be read directly
+ */
+
+Opal::Flag Opal::Counters::readDirect(uint32_t event, uint64_t& value) {
+
+    volatile perf_event_mmap_page* page = pages[event];
+
+    uint32_t sequence, index;
+
+    do {
+
+        sequence = page->lock;
+
+        __atomic_signal_fence(__ATOMIC_ACQUIRE);
+
+        index = page->index;
+        value = page->offset;
+
+        // Not on a counter right now; the kernel has the value
+        if(!page->cap_user_rdpmc || !index) return false;
+
+        // Counters are narrower than 64 bits; sign extend them
+        int64_t counter = __builtin_ia32_rdpmc(index - 1);
+        uint32_t width  = page->pmc_width;
+
+        counter <<= 64 - width;
+        counter >>= 64 - width;
+
+        value += counter;
+
+        __atomic_signal_fence(__ATOMIC_ACQUIRE);
+
+    } while(page->lock != sequence);
+
+    return true;
+
+}
+
+/*!
+ * Returns the slot of the given source, claiming one if it has
+ * none yet. Only the counted thread claims, so a slot that's seen
+ * empty stays that way until it's claimed here.
+ * \param source The source
+ * \return Reference to the slot
+ */
+
+Opal::Counters::Slot& Opal::Counters::slotOf(void* source) {
+
+    for(uint32_t probe = 0, index = SlotIndex(source, Capacity); probe < Capacity; probe++, index = (index + 1) & (Capacity - 1)) {
+
+        void* claimed = slots[index].source.load(std::memory_order_relaxed);
+
+        if(claimed == source) return slots[index];
+
+        if(claimed) continue;
+
+        slots[index].source.store(source, std::memory_order_release);
+
+        return slots[index];
+
+    }
+
+    return rest;
+
+}
+
+/// --------------
+/// Public Methods
+
+/*!
+ * Opens the group on the given thread. The first event that opens
+ * leads the group, the rest join it so they're always scheduled
+ * together. Hardware events count user space only. Software events
+ * count the kernel's side too if it lets us, since context switches
+ * only ever happen there.
+ * \param threadID The thread to count
+ * \param software Denotes if context switches and page faults are counted
+ * \return Opal::Flag denoting if any event could be opened
+ */
+
+Opal::Flag Opal::Counters::open(pid_t threadID, Opal::Flag software) {
+
+    static const uint64_t pageSize = sysconf(_SC_PAGESIZE);
+
+    close();
+
+    int32_t leader = -1;
+
+    direct = true;
+
+    for(uint32_t event = 0; event < Events; event++) {
+
+        if(!software && !Definitions[event].hardware) continue;
+
+        perf_event_attr attributes;
+
+        memset(&attributes, 0, sizeof(attributes));
+
+        attributes.size           = sizeof(attributes);
+        attributes.type           = Definitions[event].type;
+        attributes.config         = Definitions[event].config;
+        attributes.read_format    = PERF_FORMAT_GROUP;
+        attributes.exclude_kernel = Definitions[event].hardware;
+        attributes.exclude_hv     = 1;
+
+        int32_t descriptor = syscall(SYS_perf_event_open, &attributes, threadID, -1, leader, PERF_FLAG_FD_CLOEXEC);
+
+        if(descriptor < 0 && !attributes.exclude_kernel) {
+
+            attributes.exclude_kernel = 1;
+
+            descriptor = syscall(SYS_perf_event_open, &attributes, threadID, -1, leader, PERF_FLAG_FD_CLOEXEC);
+
+        }
+
+        if(descriptor < 0) continue;
+
+        if(leader < 0) leader = descriptor;
+
+        descriptors[event] = descriptor;
+        positions[event]   = members++;
+
+        void* page = Definitions[event].hardware ? mmap(0, pageSize, PROT_READ, MAP_SHARED, descriptor, 0) : MAP_FAILED;
+
+        if(page != MAP_FAILED) pages[event] = static_cast<perf_event_mmap_page*>(page);
+
+        direct = direct && pages[event] && pages[event]->cap_user_rdpmc;
+
+    }
+
+    direct = direct && members;
+
+    return members != 0;
+
+}
+
+/*!
+ * Closes the group. Attributions are kept.
+ */
+
+void Opal::Counters::close() {
+
+    static const uint64_t pageSize = sysconf(_SC_PAGESIZE);
+
+    for(uint32_t event = 0; event < Events; event++) {
+
+        if(pages[event]) munmap(pages[event], pageSize);
+
+        if(descriptors[event] >= 0) ::close(descriptors[event]);
+
+        pages[event]       = 0 ;
+        descriptors[event] = -1;
+
+    }
+
+    members = 0;
+    direct  = false;
+
+}
+
+/*!
+ * Returns a flag denoting if any event is counting.
+ * \return Opal::Flag denoting if the group is open
+ */
+
+Opal::Flag Opal::Counters::isOpen() const { return members != 0; }
+
+/*!
+ * Reads every counter with a single read() of the group leader.
+ * Any thread may read.
+ * \param sample Where the values go
+ * \return Opal::Flag denoting if the group could be read
+ */
+
+Opal::Flag Opal::Counters::read(Sample& sample) {
+
+    uint64_t values[1 + Events] = { 0 };
+    uint64_t counts[Events]     = { 0 };
+
+    int32_t leader = -1;
+
+    for(uint32_t event = 0; event < Events && leader < 0; event++)
+        if(descriptors[event] >= 0 && !positions[event]) leader = descriptors[event];
+
+    if(leader < 0 || ::read(leader, values, sizeof(values)) < static_cast<ssize_t>((1 + members) * sizeof(uint64_t))) return false;
+
+    for(uint32_t event = 0; event < Events; event++)
+        if(descriptors[event] >= 0) counts[event] = values[1 + positions[event]];
+
+    sample = Sample{ counts[0], counts[1], counts[2], counts[3], counts[4] };
+
+    return true;
+
+}
+
+/*!
+ * Reads every counter from the counted thread itself. A hardware only
+ * group is read with rdpmc alone, without entering the kernel; any
+ * event that isn't on a counter at the moment sends the whole group
+ * through read().
+ * \param sample Where the values go
+ * \return Opal::Flag denoting if the group could be read
+ */
+
+Opal::Flag Opal::Counters::readSelf(Sample& sample) {
+
+    if(!direct) return read(sample);
+
+    uint64_t counts[Events] = { 0 };
+
+    for(uint32_t event = 0; event < Events; event++)
+        if(descriptors[event] >= 0 && !readDirect(event, counts[event])) return read(sample);
+
+    sample = Sample{ counts[0], counts[1], counts[2], counts[3], counts[4] };
+
+    return true;
+
+}
+
+/*!
+ * Adds what was counted in between the given samples to the given
+ * source. Must be invoked by the counted thread; readers may see a
+ * run's counts before its' run is added, never the other way around.
+ * \param source Where the run came from
+ * \param before The sample taken before the run
+ * \param after The sample taken after the run
+ */
+
+void Opal::Counters::attribute(void* source, const Sample& before, const Sample& after) {
+
+    Slot& slot = slotOf(source);
+
+    const uint64_t deltas[Events] = {
+
+        after.cycles          - before.cycles          ,
+        after.instructions    - before.instructions    ,
+        after.cacheMisses     - before.cacheMisses     ,
+        after.contextSwitches - before.contextSwitches ,
+        after.pageFaults      - before.pageFaults
+
+    };
+
+    for(uint32_t event = 0; event < Events; event++)
+        slot.total[event].store(slot.total[event].load(std::memory_order_relaxed) + deltas[event], std::memory_order_relaxed);
+
+    slot.runs.store(slot.runs.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+}
+
+/*!
+ * Copies the attributions into the given array, in no particular
+ * order. The sources that didn't fit come last, with a null
+ * source, if there are any. Any thread may invoke; attributions
+ * that are being added to may be off by the run in progress.
+ * \param attributions The array to fill
+ * \param capacity The capacity of the array
+ * \return the amount of attributions written
+ */
+
+uint32_t Opal::Counters::getAttributions(Attribution* attributions, uint32_t capacity) {
+
+    uint32_t written = 0;
+
+    auto Copy = [&](Slot& slot, void* source) {
+
+        Attribution& attribution = attributions[written++];
+
+        attribution.source = source;
+        attribution.runs   = slot.runs.load(std::memory_order_acquire);
+        attribution.total  = Sample{ slot.total[0].load(std::memory_order_relaxed), slot.total[1].load(std::memory_order_relaxed),
+                                     slot.total[2].load(std::memory_order_relaxed), slot.total[3].load(std::memory_order_relaxed),
+                                     slot.total[4].load(std::memory_order_relaxed) };
+
+    };
+
+    for(uint32_t index = 0; index < Capacity && written < capacity; index++) {
+
+        void* source = slots[index].source.load(std::memory_order_acquire);
+
+        if(source && slots[index].runs.load(std::memory_order_acquire)) Copy(slots[index], source);
+
+    }
+
+    if(written < capacity && rest.runs.load(std::memory_order_acquire)) Copy(rest, 0);
+
+    return written;
+
+}
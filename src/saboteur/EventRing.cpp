@@ -0,0 +1,143 @@
+/*!
+ * Opal::EventRing implementation
+ *
+ * \author: Carlos L. Cuenca
+ */
+
+#include<EventRing.hpp>
+#include<Saboteur.hpp>
+
+/// ------------
+/// Constructors
+
+/*!
+ * Default Constructor. Initializes an empty Opal::EventRing.
+ */
+
+Opal::EventRing::EventRing():
+cells(), recordIndex(0), drainIndex(0), dropped(0), coalesced(0) {
+
+    // Every cell is ready to be written at its' own position
+    for(uint64_t index = 0; index < Capacity; index++) {
+
+        cells[index].sequence.store(index, std::memory_order_relaxed);
+        cells[index].state = CLEAR;
+
+    }
+
+}
+
+/// --------------
+/// Public Methods
+
+/*!
+ * Appends the given transition. Any number of threads may record
+ * at once.
+ * \param state The Opal::State transitioned to
+ * \return Opal::Flag denoting if the transition was recorded; false
+ * if the Opal::EventRing is full and it was dropped.
+ */
+
+Opal::Flag Opal::EventRing::record(Opal::State state) {
+
+    uint64_t position = recordIndex.load(std::memory_order_relaxed);
+    Cell*    cell     = 0;
+
+    while(true) {
+
+        cell = &cells[position & (Capacity - 1)];
+
+        int64_t difference = static_cast<int64_t>(cell->sequence.load(std::memory_order_acquire) - position);
+
+        // The cell is ready to be written; claim it
+        if(!difference) {
+
+            if(recordIndex.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+
+        }
+
+        // The drainer hasn't caught up; drop it
+        else if(difference < 0) {
+
+            dropped.fetch_add(1, std::memory_order_relaxed);
+
+            return false;
+
+        }
+
+        // Someone else claimed it; catch up
+        else position = recordIndex.load(std::memory_order_relaxed);
+
+    }
+
+    cell->state = state;
+    cell->sequence.store(position + 1, std::memory_order_release);
+
+    return true;
+
+}
+
+/*!
+ * Removes up to the given amount of the oldest transitions and
+ * copies them into the given buffer. A WAITING transition directly
+ * followed by a STARTED one is removed along with it; the observer
+ * would only hear that the Opal::Saboteur went idle and immediately
+ * picked something up again. Only one thread may drain.
+ * \param states The buffer to copy into
+ * \param count The capacity of the buffer
+ * \return the amount of transitions copied
+ */
+
+uint64_t Opal::EventRing::drain(Opal::State* states, uint64_t count) {
+
+    uint64_t copied  = 0;
+    uint64_t removed = 0;
+
+    while(copied < count) {
+
+        Cell* cell = &cells[drainIndex & (Capacity - 1)];
+
+        // Nothing more has been written
+        if(cell->sequence.load(std::memory_order_acquire) != drainIndex + 1) break;
+
+        Opal::State state = cell->state;
+
+        // Ready the cell for the next lap
+        cell->sequence.store(drainIndex + Capacity, std::memory_order_release);
+
+        drainIndex++;
+
+        // Idle and straight back to work; neither is worth a callback
+        if(state == STARTED && copied && states[copied - 1] == WAITING) {
+
+            copied--;
+            removed += 2;
+
+            continue;
+
+        }
+
+        states[copied++] = state;
+
+    }
+
+    if(removed) coalesced.fetch_add(removed, std::memory_order_relaxed);
+
+    return copied;
+
+}
+
+/*!
+ * Returns the amount of transitions that were dropped because
+ * the Opal::EventRing was full.
+ * \return the amount of dropped transitions
+ */
+
+uint64_t Opal::EventRing::getDropped() { return dropped.load(std::memory_order_relaxed); }
+
+/*!
+ * Returns the amount of transitions that were coalesced away.
+ * \return the amount of coalesced transitions
+ */
+
+uint64_t Opal::EventRing::getCoalesced() { return coalesced.load(std::memory_order_relaxed); }
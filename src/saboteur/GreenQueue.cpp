@@ -0,0 +1,92 @@
+/*!
+ * Opal::GreenQueue implementation
+ *
+ * \author: Carlos L. Cuenca
+ */
+
+#include<GreenQueue.hpp>
+
+/// ------------
+/// Constructors
+
+/*!
+ * Default Constructor. Initializes an empty Opal::GreenQueue;
+ * both ends sit on the stub.
+ */
+
+Opal::GreenQueue::GreenQueue(): head(&stub), tail(&stub), stub() {
+
+    stub.next.store(0, std::memory_order_relaxed);
+
+}
+
+/// --------------
+/// Public Methods
+
+/*!
+ * Pushes the given link to the back of the Opal::GreenQueue.
+ * Any thread may push. The link becomes the head with a single
+ * exchange; it's reachable from the front once the previous head
+ * points at it.
+ * \param link The link to push
+ */
+
+void Opal::GreenQueue::push(Link* link) {
+
+    link->next.store(0, std::memory_order_relaxed);
+
+    Link* previous = head.exchange(link, std::memory_order_acq_rel);
+
+    previous->next.store(link, std::memory_order_release);
+
+}
+
+/*!
+ * Removes and returns the link at the front. Consumer only.
+ * \return the link, or null if there is none or a push hasn't
+ * finished linking yet.
+ */
+
+Opal::GreenQueue::Link* Opal::GreenQueue::pop() {
+
+    Link* tail = this->tail;
+    Link* next = tail->next.load(std::memory_order_acquire);
+
+    // Step over the stub
+    if(tail == &stub) {
+
+        if(!next) return 0;
+
+        this->tail = next;
+        tail       = next;
+        next       = next->next.load(std::memory_order_acquire);
+
+    }
+
+    if(next) { this->tail = next; return tail; }
+
+    // Someone is in the middle of pushing behind the tail
+    if(tail != head.load(std::memory_order_acquire)) return 0;
+
+    // The tail is the last link; put the stub behind it so it can go
+    push(&stub);
+
+    next = tail->next.load(std::memory_order_acquire);
+
+    if(next) { this->tail = next; return tail; }
+
+    return 0;
+
+}
+
+/*!
+ * Returns a flag denoting if the Opal::GreenQueue holds nothing,
+ * not even a push in progress. Consumer only.
+ * \return Opal::Flag denoting if the Opal::GreenQueue is empty
+ */
+
+Opal::Flag Opal::GreenQueue::isEmpty() {
+
+    return tail == &stub && head.load(std::memory_order_acquire) == &stub;
+
+}
@@ -0,0 +1,427 @@
+/*!
+ * Opal::GreenTask implementation
+ *
+ * \author: Carlos L. Cuenca
+ */
+
+#include<GreenTask.hpp>
+#include<Saboteur.hpp>
+
+/// ---------------------
+/// Static Initialization
+
+Opal::Atomic<uint64_t> Opal::GreenTask::Released (0);
+Opal::Atomic<uint64_t> Opal::GreenTask::Mapped   (0);
+
+/// -----------------
+/// Macro Definitions
+
+// Omit from documentation
+// Why a green task switched out, and whether it's suspended. A
+// wake that beats the suspension it's meant for leaves it woken.
+#define GREEN_RELINQUISH    0
+#define GREEN_SUSPEND       1
+#define GREEN_FINISH        2
+#define GREEN_PREEMPT       3
+#define GREEN_MIGRATE       4
+#define GREEN_RUNNING       0
+#define GREEN_SUSPENDED     1
+#define GREEN_WOKEN         2
+
+// The value every canary holds while its' stack is intact
+#define GREEN_CANARY        0x5AB07E0125A1F00DULL
+
+// The released stacks are a lock-free stack; its' top holds the
+// stack's base in the low 33 bits (bases are aligned to the stack
+// size and below 2^47) and the update count in the rest.
+#define StackBase(top)              reinterpret_cast<uint8_t*>(((top) & ((1ULL << 33) - 1)) << 14)
+#define StackTop(base, count)       (((count) << 33) | (reinterpret_cast<uint64_t>(base) >> 14))
+// A released stack links to the next one where its' Opal::GreenTask
+// was, so the only page it ever touched is the one that stays touched.
+#define NextStack(base)             (*reinterpret_cast<uint8_t**>((base) + StackSize - sizeof(uint8_t*)))
+
+/// ------------
+/// Constructors
+
+/*!
+ * Initializes the Opal::GreenTask at the top of its' stack. The stack
+ * below it is made to look like a context that switched out, so the
+ * first switch to it returns into ContextStart, which invokes Entry()
+ * with the Opal::GreenTask on a 16-byte aligned stack.
+ * \param body What the task executes
+ * \param owner The Opal::Saboteur the task runs on
+ */
+
+Opal::GreenTask::GreenTask(Opal::Task&& body, Opal::Saboteur* owner):
+Opal::GreenQueue::Link(), context(0), worker(0), body(static_cast<Opal::Task&&>(body)),
+owner(owner), state(GREEN_RUNNING), action(GREEN_RELINQUISH), migrating(0), canary(GREEN_CANARY) {
+
+    uint64_t* frame = reinterpret_cast<uint64_t*>(this) - 10;
+
+    frame[0] = 0x1F80 | (0x037FULL << 32);                      // Default mxcsr & x87 control word
+    frame[1] = 0;                                               // r15
+    frame[2] = 0;                                               // r14
+    frame[3] = reinterpret_cast<uint64_t>(&Entry);              // r13
+    frame[4] = reinterpret_cast<uint64_t>(this);                // r12
+    frame[5] = 0;                                               // rbx
+    frame[6] = 0;                                               // rbp
+    frame[7] = reinterpret_cast<uint64_t>(&ContextStart);       // Return address
+    frame[8] = 0;                                               // Alignment
+    frame[9] = 0;
+
+    context = frame;
+
+}
+
+/// ------------------------
+/// Private Static Functions
+
+/*!
+ * The first function a green task executes. Runs the body, drops it
+ * while still on the green stack, and switches out for the last time.
+ * An exception escaping the body terminates the process, as it would
+ * on any other thread.
+ * \param task The Opal::GreenTask starting up
+ */
+
+void Opal::GreenTask::Entry(GreenTask* task) noexcept {
+
+    task->body();
+    task->body.reset();
+
+    SwitchOut(task, GREEN_FINISH);
+
+}
+
+/*!
+ * Returns the base of an unused green stack. Released stacks are
+ * reused first, otherwise a slab of them is mapped at once. The slab
+ * is mapped one stack larger than it needs to be and trimmed, so every
+ * stack in it is aligned to its' size. Slabs are never unmapped, so a
+ * base that was taken in the meantime is still safe to read.
+ * \return the lowest address of the stack, or null if the mapping failed.
+ */
+
+uint8_t* Opal::GreenTask::Allocate() {
+
+    uint64_t top = Released.load(std::memory_order_acquire);
+
+    while(StackBase(top)) {
+
+        uint8_t* base = StackBase(top);
+
+        if(Released.compare_exchange_weak(top, StackTop(NextStack(base), (top >> 33) + 1),
+                                          std::memory_order_acquire, std::memory_order_acquire)) return base;
+
+    }
+
+    const uint64_t size = (SlabSize + 1) * StackSize;
+
+    // Pages are only committed once a task touches them
+    uint8_t* region = static_cast<uint8_t*>(mmap(0, size, PROT_READ | PROT_WRITE,
+                                                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0));
+
+    if(region == MAP_FAILED) return 0;
+
+    uint8_t* slab = reinterpret_cast<uint8_t*>((reinterpret_cast<uint64_t>(region) + StackSize - 1) & ~(StackSize - 1));
+    uint8_t* end  = slab + SlabSize * StackSize;
+
+    // Trim the unaligned head and whatever's left past the last stack
+    if(slab != region)       munmap(region, slab - region);
+    if(end  != region + size) munmap(end, region + size - end);
+
+    Mapped.fetch_add(SlabSize, std::memory_order_relaxed);
+
+    // Keep the first stack, release the rest in one go
+    for(uint8_t* base = slab + StackSize; base + StackSize < end; base += StackSize)
+        NextStack(base) = base + StackSize;
+
+    Release(slab + StackSize, end - StackSize);
+
+    return slab;
+
+}
+
+/*!
+ * Returns the given chain of green stacks to the unused ones.
+ * Each stack links to the next one at its' top.
+ * \param first The lowest address of the first stack in the chain
+ * \param last The lowest address of the last stack in the chain
+ */
+
+void Opal::GreenTask::Release(uint8_t* first, uint8_t* last) {
+
+    uint64_t top = Released.load(std::memory_order_relaxed);
+
+    do { NextStack(last) = StackBase(top); }
+    while(!Released.compare_exchange_weak(top, StackTop(first, (top >> 33) + 1),
+                                          std::memory_order_release, std::memory_order_relaxed));
+
+}
+
+/*!
+ * Switches from the running green task back to its' worker,
+ * recording why. Returns once the task is resumed.
+ * \param task The running Opal::GreenTask
+ * \param action Why the task switches out
+ */
+
+void Opal::GreenTask::SwitchOut(GreenTask* task, uint32_t action) {
+
+    task->action = action;
+
+    SwitchContext(&task->context, task->worker);
+
+}
+
+/// -----------------------
+/// Public Static Functions
+
+/*!
+ * Creates an Opal::GreenTask at the top of an unused green stack.
+ * \param body What the task executes
+ * \param owner The Opal::Saboteur the task runs on
+ * \return Pointer to the Opal::GreenTask
+ * \throws GreenTaskCreateFailureException if no stack could be mapped.
+ */
+
+Opal::GreenTask* Opal::GreenTask::Create(Opal::Task&& body, Opal::Saboteur* owner) {
+
+    uint8_t* base = Allocate();
+
+    if(!base) throw GreenTaskCreateFailureException();
+
+    return new (base + StackSize - sizeof(GreenTask)) GreenTask(static_cast<Opal::Task&&>(body), owner);
+
+}
+
+/*!
+ * Runs the given Opal::GreenTask on the invoking worker until it
+ * switches out, then checks the stack it left behind. A relinquished
+ * task is queued on its' Opal::Saboteur again without waking it; the
+ * worker is the one about to look; a preempted one is demoted behind
+ * the ready ones. A suspending task is left alone
+ * unless a wake beat it to it. A finished task is destroyed and its'
+ * stack released.
+ * \param task The Opal::GreenTask to run
+ * \throws GreenStackOverflowException if the task overflowed its' stack.
+ */
+
+void Opal::GreenTask::Resume(GreenTask* task) {
+
+    uint8_t* base = reinterpret_cast<uint8_t*>(task) + sizeof(GreenTask) - StackSize;
+
+    task->action = GREEN_RELINQUISH;
+
+    // First time around since it was handed over from another worker
+    if(Expect(task->migrating != 0, 0)) {
+
+        task->owner->migrated(Now() - task->migrating);
+
+        task->migrating = 0;
+
+    }
+
+    SwitchContext(&task->worker, task->context);
+
+    if(Expect(task->canary != GREEN_CANARY || static_cast<uint8_t*>(task->context) < base, 0))
+        throw GreenStackOverflowException();
+
+    switch(task->action) {
+
+        case GREEN_FINISH:
+
+            task->~GreenTask();
+
+            Release(base, base);
+
+            return;
+
+        case GREEN_SUSPEND: {
+
+            uint32_t expected = GREEN_RUNNING;
+
+            if(task->state.compare_exchange_strong(expected, GREEN_SUSPENDED)) return;
+
+            // Woken while switching out; run it again
+            task->state.store(GREEN_RUNNING);
+
+        }
+
+        [[fallthrough]];
+
+        case GREEN_RELINQUISH: task->owner->enqueue(task, false); return;
+
+        // Handed over; the new owner may be parked
+        case GREEN_MIGRATE: task->owner->enqueue(task); return;
+
+        default: task->owner->demote(task);
+
+    }
+
+}
+
+/*!
+ * Returns the Opal::GreenTask running on the invoking thread. Green
+ * stacks are aligned to their size and the Opal::GreenTask sits at
+ * the top, so it's found from the frame address alone.
+ * \return Pointer to the running Opal::GreenTask
+ */
+
+Opal::GreenTask* Opal::GreenTask::Current() {
+
+    return Of(__builtin_frame_address(0));
+
+}
+
+/*!
+ * Returns the Opal::GreenTask at the top of the stack sized, stack
+ * aligned block the given address is in. Whether there's a green
+ * stack there is up to the caller.
+ * \param address The address, usually a stack pointer
+ * \return Pointer to the Opal::GreenTask
+ */
+
+Opal::GreenTask* Opal::GreenTask::Of(void* address) {
+
+    uint64_t base = reinterpret_cast<uint64_t>(address) & ~(StackSize - 1);
+
+    return reinterpret_cast<GreenTask*>(base + StackSize - sizeof(GreenTask));
+
+}
+
+/*!
+ * Lets the other green tasks of the Opal::Saboteur run.
+ */
+
+void Opal::GreenTask::Relinquish() {
+
+    SwitchOut(Current(), GREEN_RELINQUISH);
+
+}
+
+/*!
+ * Switches the invoking green task out as if its' time slice ran out.
+ */
+
+void Opal::GreenTask::Preempt() {
+
+    SwitchOut(Current(), GREEN_PREEMPT);
+
+}
+
+/*!
+ * Switches the invoking green task out to the Opal::Saboteur it was
+ * handed over to. The task may have been stopped halfway through
+ * switching out for another reason, which it finishes once it's
+ * continued; so that reason is put back as it was.
+ */
+
+void Opal::GreenTask::Migrate() {
+
+    GreenTask* task   = Current();
+    uint32_t   action = task->action;
+
+    SwitchOut(task, GREEN_MIGRATE);
+
+    task->action = action;
+
+}
+
+/*!
+ * Suspends the invoking green task until it's woken. A pending
+ * wake is consumed instead of switching out.
+ */
+
+void Opal::GreenTask::Suspend() {
+
+    GreenTask* task     = Current();
+    uint32_t   expected = GREEN_WOKEN;
+
+    if(task->state.compare_exchange_strong(expected, GREEN_RUNNING)) return;
+
+    SwitchOut(task, GREEN_SUSPEND);
+
+}
+
+/*!
+ * Wakes the given Opal::GreenTask. A suspended task is queued on its'
+ * Opal::Saboteur; a running one has the wake recorded for its' next
+ * suspension. Wakes don't accumulate.
+ * \param task The Opal::GreenTask to wake
+ */
+
+void Opal::GreenTask::Wake(GreenTask* task) {
+
+    uint32_t state = task->state.load();
+
+    while(state != GREEN_WOKEN) {
+
+        if(state == GREEN_SUSPENDED) {
+
+            if(task->state.compare_exchange_weak(state, GREEN_RUNNING)) {
+
+                task->owner->enqueue(task);
+
+                return;
+
+            }
+
+        } else if(task->state.compare_exchange_weak(state, GREEN_WOKEN)) return;
+
+    }
+
+}
+
+/*!
+ * Returns the amount of green stacks that have been mapped.
+ * \return the amount of mapped green stacks
+ */
+
+uint64_t Opal::GreenTask::GetMapped() {
+
+    return Mapped.load(std::memory_order_relaxed);
+
+}
+
+/// --------------
+/// Public Methods
+
+/*!
+ * Returns the Opal::Saboteur the Opal::GreenTask runs on.
+ * \return Pointer to the Opal::Saboteur
+ */
+
+Opal::Saboteur* Opal::GreenTask::getOwner() {
+
+    return owner;
+
+}
+
+/*!
+ * Hands the Opal::GreenTask over to the given Opal::Saboteur. Its'
+ * worker is stopped, so nothing else looks at the owner until the
+ * task switches out in Migrate(); a suspended task's owner is only
+ * looked at by its' wake, and a running one isn't suspended.
+ * \param owner The Opal::Saboteur the task continues on
+ * \param stoppedAt When the worker running it was stopped
+ */
+
+void Opal::GreenTask::handOver(Opal::Saboteur* owner, Opal::Nanoseconds stoppedAt) {
+
+    this->owner = owner;
+    migrating   = stoppedAt;
+
+}
+
+/*!
+ * Returns what identifies the kind of body the Opal::GreenTask runs;
+ * every green task spawned from the same type of callable shares it.
+ * \return the source of the body
+ */
+
+void* Opal::GreenTask::getSource() const {
+
+    return body.getSource();
+
+}
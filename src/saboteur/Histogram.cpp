@@ -0,0 +1,243 @@
+/*!
+ * Opal::Histogram implementation
+ *
+ * \author: Carlos L. Cuenca
+ */
+
+#include<Histogram.hpp>
+
+/// -----------------
+/// Macro Definitions
+
+// Omit from documentation
+// The bits of a value that pick its' bucket within its' range
+#define SubBucketBits       __builtin_ctz(Opal::Histogram::SubBuckets)
+
+/// ------------
+/// Constructors
+
+/*!
+ * Default Constructor. Initializes an empty Opal::Histogram.
+ */
+
+Opal::Histogram::Histogram(): counts(), count(0), sum(0), minimum(UINT64_MAX), maximum(0) { /* Empty */ }
+
+/// ----------------------
+/// Public Static Methods
+
+/*!
+ * Returns the bucket the given value falls in. Values below SubBuckets
+ * get a bucket each. Every power of two range above that keeps the
+ * bits below its' leading one that pick one of SubBuckets buckets,
+ * and drops the rest.
+ * \param value The value
+ * \return the index of the bucket
+ */
+
+uint32_t Opal::Histogram::IndexOf(uint64_t value) {
+
+    if(value < SubBuckets) return value;
+
+    uint32_t exponent = 63 - __builtin_clzll(value);
+    uint32_t range    = exponent - SubBucketBits + 1;
+
+    if(range > Ranges) return Buckets - 1;
+
+    return range * SubBuckets + ((value >> (exponent - SubBucketBits)) & (SubBuckets - 1));
+
+}
+
+/*!
+ * Returns the lowest value that falls in the given bucket.
+ * \param index The index of the bucket
+ * \return the lowest value of the bucket
+ */
+
+uint64_t Opal::Histogram::ValueOf(uint32_t index) {
+
+    if(index < SubBuckets) return index;
+
+    uint32_t range = index / SubBuckets;
+
+    return static_cast<uint64_t>(SubBuckets + index % SubBuckets) << (range - 1);
+
+}
+
+/// --------------
+/// Public Methods
+
+/*!
+ * Records the given value. Any thread may record; each counter is
+ * updated on its' own, so a reader may see a value in its' bucket
+ * before it's in the count.
+ * \param value The value in nanoseconds
+ */
+
+void Opal::Histogram::record(uint64_t value) {
+
+    counts[IndexOf(value)].fetch_add(1, std::memory_order_relaxed);
+
+    count.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t current = minimum.load(std::memory_order_relaxed);
+
+    while(value < current && !minimum.compare_exchange_weak(current, value, std::memory_order_relaxed));
+
+    current = maximum.load(std::memory_order_relaxed);
+
+    while(value > current && !maximum.compare_exchange_weak(current, value, std::memory_order_relaxed));
+
+}
+
+/*!
+ * Adds every value recorded in the given Opal::Histogram. Both
+ * may be recorded to meanwhile.
+ * \param histogram The Opal::Histogram to add
+ */
+
+void Opal::Histogram::merge(const Histogram& histogram) {
+
+    for(uint32_t index = 0; index < Buckets; index++) {
+
+        uint64_t values = histogram.counts[index].load(std::memory_order_relaxed);
+
+        if(values) counts[index].fetch_add(values, std::memory_order_relaxed);
+
+    }
+
+    count.fetch_add(histogram.count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    sum.fetch_add(histogram.sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+    uint64_t value   = histogram.minimum.load(std::memory_order_relaxed);
+    uint64_t current = minimum.load(std::memory_order_relaxed);
+
+    while(value < current && !minimum.compare_exchange_weak(current, value, std::memory_order_relaxed));
+
+    value   = histogram.maximum.load(std::memory_order_relaxed);
+    current = maximum.load(std::memory_order_relaxed);
+
+    while(value > current && !maximum.compare_exchange_weak(current, value, std::memory_order_relaxed));
+
+}
+
+/*!
+ * Forgets every recorded value. Values recorded meanwhile
+ * may be partially forgotten.
+ */
+
+void Opal::Histogram::reset() {
+
+    for(uint32_t index = 0; index < Buckets; index++) counts[index].store(0, std::memory_order_relaxed);
+
+    count.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    minimum.store(UINT64_MAX, std::memory_order_relaxed);
+    maximum.store(0, std::memory_order_relaxed);
+
+}
+
+/*!
+ * Returns the value below which the given percentage of the recorded
+ * values fall, as the highest value of its' bucket; never past the
+ * largest value recorded.
+ * \param percentile The percentile, from 0 to 100
+ * \return the value, or zero if nothing was recorded
+ */
+
+uint64_t Opal::Histogram::getPercentile(double percentile) const {
+
+    uint64_t values = 0;
+
+    // The buckets may be ahead of the count; go by the buckets
+    for(uint32_t index = 0; index < Buckets; index++) values += counts[index].load(std::memory_order_relaxed);
+
+    if(!values) return 0;
+
+    if(percentile > 100.0) percentile = 100.0;
+
+    uint64_t target = static_cast<uint64_t>(percentile / 100.0 * values + 0.5);
+    uint64_t seen   = 0;
+
+    if(!target) target = 1;
+
+    for(uint32_t index = 0; index < Buckets; index++) {
+
+        seen += counts[index].load(std::memory_order_relaxed);
+
+        if(seen < target) continue;
+
+        uint64_t highest = index + 1 < Buckets ? ValueOf(index + 1) - 1 : ValueOf(index);
+        uint64_t largest = maximum.load(std::memory_order_relaxed);
+
+        return highest < largest ? highest : largest;
+
+    }
+
+    return maximum.load(std::memory_order_relaxed);
+
+}
+
+/*!
+ * Copies the buckets that hold values into the given array,
+ * lowest first.
+ * \param buckets The array to fill
+ * \param capacity The capacity of the array
+ * \return the amount of buckets written
+ */
+
+uint32_t Opal::Histogram::getBuckets(Bucket* buckets, uint32_t capacity) const {
+
+    uint32_t written = 0;
+
+    for(uint32_t index = 0; index < Buckets && written < capacity; index++) {
+
+        uint64_t values = counts[index].load(std::memory_order_relaxed);
+
+        if(values) buckets[written++] = Bucket{ ValueOf(index), values };
+
+    }
+
+    return written;
+
+}
+
+/*!
+ * Returns the amount of values recorded.
+ * \return the amount of values
+ */
+
+uint64_t Opal::Histogram::getCount() const { return count.load(std::memory_order_relaxed); }
+
+/*!
+ * Returns the mean of the values recorded.
+ * \return the mean, or zero if nothing was recorded
+ */
+
+double Opal::Histogram::getMean() const {
+
+    uint64_t values = count.load(std::memory_order_relaxed);
+
+    return values ? static_cast<double>(sum.load(std::memory_order_relaxed)) / values : 0.0;
+
+}
+
+/*!
+ * Returns the smallest value recorded.
+ * \return the smallest value, or zero if nothing was recorded
+ */
+
+uint64_t Opal::Histogram::getMinimum() const {
+
+    uint64_t value = minimum.load(std::memory_order_relaxed);
+
+    return value == UINT64_MAX ? 0 : value;
+
+}
+
+/*!
+ * Returns the largest value recorded.
+ * \return the largest value
+ */
+
+uint64_t Opal::Histogram::getMaximum() const { return maximum.load(std::memory_order_relaxed); }
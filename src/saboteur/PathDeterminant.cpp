@@ -0,0 +1,482 @@
+/*!
+ * Opal::PathDeterminant implementation
+ *
+ * \author: Carlos L. Cuenca
+ */
+
+#include<PathDeterminant.hpp>
+#include<GreenTask.hpp>
+
+/// -----------------
+/// Macro Definitions
+
+// Omit from documentation
+// A tagged head holds the node index (plus one) in the low half
+// and the update count in the high half.
+#define TaggedIndex(head)      static_cast<uint32_t>(head)
+#define TaggedCount(head)      ((head) >> 32)
+#define Tagged(index, count)   ((static_cast<uint64_t>(count) << 32) | (index))
+
+// Queued tasks and continuations are pointers with one of the top
+// two bits set, green tasks with both; user space addresses never
+// reach that high, so no execution address looks like any of them.
+#define TaskBit                (1ULL << 63)
+#define ContinuationBit        (1ULL << 62)
+#define TagBits                (TaskBit | ContinuationBit)
+#define TaskTag(node)          reinterpret_cast<void*>(reinterpret_cast<uint64_t>(node) | TaskBit)
+#define TaskNode(address)      reinterpret_cast<Node*>(reinterpret_cast<uint64_t>(address) & ~TagBits)
+#define ContinuationFrame(address) reinterpret_cast<void*>(reinterpret_cast<uint64_t>(address) & ~TagBits)
+#define GreenTaskOf(address)   reinterpret_cast<Opal::GreenTask*>(reinterpret_cast<uint64_t>(address) & ~TagBits)
+
+/// ------------
+/// Constructors
+
+/*!
+ * Default Constructor. Initializes an empty Opal::PathDeterminant.
+ * Every node starts out unused.
+ */
+
+Opal::PathDeterminant::PathDeterminant():
+nodes(), pushed(0), available(0), cells(), placeIndex(0), takeIndex(0), stamping(false) {
+
+    for(uint32_t index = 0; index < Capacity; index++) {
+
+        // Chain the unused nodes
+        nodes[index].next.store(index + 1 < Capacity ? index + 2 : 0, std::memory_order_relaxed);
+        nodes[index].address = 0;
+        nodes[index].queued  = 0;
+        nodes[index].owner   = this;
+
+        // Every cell is ready to be written at its' own position
+        cells[index].sequence.store(index, std::memory_order_relaxed);
+        cells[index].address = 0;
+        cells[index].queued  = 0;
+
+    }
+
+    available.store(Tagged(1, 0), std::memory_order_release);
+
+}
+
+/// ---------------
+/// Private Methods
+
+/*!
+ * Pops the node at the top of the given tagged stack.
+ * \param stack The tagged head of the stack
+ * \return the index of the node plus one, or zero if the stack is empty
+ */
+
+uint32_t Opal::PathDeterminant::popFrom(Opal::Atomic<uint64_t>& stack) {
+
+    uint64_t head = stack.load(std::memory_order_acquire);
+
+    // The tag changes on every update, so a node that was popped and
+    // pushed back in the meantime fails the exchange.
+    while(TaggedIndex(head)) {
+
+        uint32_t next = nodes[TaggedIndex(head) - 1].next.load(std::memory_order_relaxed);
+
+        if(stack.compare_exchange_weak(head, Tagged(next, TaggedCount(head) + 1),
+                                       std::memory_order_acq_rel, std::memory_order_acquire))
+            return TaggedIndex(head);
+
+    }
+
+    return 0;
+
+}
+
+/*!
+ * Pushes the given node on top of the given tagged stack.
+ * \param stack The tagged head of the stack
+ * \param node The index of the node plus one
+ */
+
+void Opal::PathDeterminant::pushOnto(Opal::Atomic<uint64_t>& stack, uint32_t node) {
+
+    uint64_t head = stack.load(std::memory_order_relaxed);
+
+    do nodes[node - 1].next.store(TaggedIndex(head), std::memory_order_relaxed);
+
+    while(!stack.compare_exchange_weak(head, Tagged(node, TaggedCount(head) + 1),
+                                       std::memory_order_release, std::memory_order_relaxed));
+
+}
+
+/*!
+ * Stores the given Opal::Task in an unused node.
+ * \param task The Opal::Task to store
+ * \return the index of the node plus one, or zero if there's no room
+ */
+
+uint32_t Opal::PathDeterminant::store(Opal::Task&& task) {
+
+    uint32_t node = popFrom(available);
+
+    if(!node) return 0;
+
+    nodes[node - 1].task    = std::move(task)           ;
+    nodes[node - 1].address = TaskTag(&nodes[node - 1]) ;
+
+    return node;
+
+}
+
+/*!
+ * Destroys the Opal::Task of the given node and returns
+ * the node to the unused ones.
+ * \param node The node
+ */
+
+void Opal::PathDeterminant::release(Node* node) {
+
+    node->task.reset();
+
+    pushOnto(available, static_cast<uint32_t>(node - nodes) + 1);
+
+}
+
+/// ----------------------
+/// Public Static Methods
+
+/*!
+ * Returns a flag denoting if the given execution address
+ * represents a queued Opal::Task.
+ * \param address The execution address
+ * \return Opal::Flag denoting if the address is an Opal::Task
+ */
+
+Opal::Flag Opal::PathDeterminant::IsTask(void* address) {
+
+    return (reinterpret_cast<uint64_t>(address) & TagBits) == TaskBit;
+
+}
+
+/*!
+ * Returns the execution address that resumes the coroutine with the
+ * given frame. Queuing it queues the coroutine handle itself.
+ * \param frame The address of the coroutine's frame
+ * \return the execution address
+ */
+
+void* Opal::PathDeterminant::Continuation(void* frame) {
+
+    return reinterpret_cast<void*>(reinterpret_cast<uint64_t>(frame) | ContinuationBit);
+
+}
+
+/*!
+ * Returns a flag denoting if the given execution address
+ * resumes a coroutine.
+ * \param address The execution address
+ * \return Opal::Flag denoting if the address is a continuation
+ */
+
+Opal::Flag Opal::PathDeterminant::IsContinuation(void* address) {
+
+    return (reinterpret_cast<uint64_t>(address) & TagBits) == ContinuationBit;
+
+}
+
+/*!
+ * Returns the execution address that resumes the given green task.
+ * \param task The Opal::GreenTask
+ * \return the execution address
+ */
+
+void* Opal::PathDeterminant::Green(void* task) {
+
+    return reinterpret_cast<void*>(reinterpret_cast<uint64_t>(task) | TagBits);
+
+}
+
+/*!
+ * Returns a flag denoting if the given execution address
+ * resumes a green task.
+ * \param address The execution address
+ * \return Opal::Flag denoting if the address is a green task
+ */
+
+Opal::Flag Opal::PathDeterminant::IsGreen(void* address) {
+
+    return (reinterpret_cast<uint64_t>(address) & TagBits) == TagBits;
+
+}
+
+/*!
+ * Executes the given execution address. A queued Opal::Task is
+ * invoked and released, a continuation resumes its' coroutine, a
+ * green task is resumed on the invoking worker, and anything else
+ * is called as a function. Any thread may run an address taken
+ * from any Opal::PathDeterminant.
+ * \param address The execution address
+ */
+
+void Opal::PathDeterminant::Run(void* address) {
+
+#if __cpp_impl_coroutine
+
+    if(IsContinuation(address)) { std::coroutine_handle<>::from_address(ContinuationFrame(address)).resume(); return; }
+
+#endif
+
+    if(IsGreen(address)) { Opal::GreenTask::Resume(GreenTaskOf(address)); return; }
+
+    if(!IsTask(address)) { reinterpret_cast<void (*)(void)>(address)(); return; }
+
+    Node* node = TaskNode(address);
+
+    node->task();
+
+    node->owner->release(node);
+
+}
+
+/*!
+ * Returns where the given execution address came from. A queued
+ * Opal::Task or green task comes from the kind of callable it holds,
+ * and a continuation from its' coroutine, whose resume function leads
+ * its' frame. Anything else comes from itself. Must be invoked before
+ * the address is run; running it may release what it points at.
+ * \param address The execution address
+ * \return the source
+ */
+
+void* Opal::PathDeterminant::Source(void* address) {
+
+    if(IsContinuation(address)) return *static_cast<void**>(ContinuationFrame(address));
+
+    if(IsGreen(address)) return GreenTaskOf(address)->getSource();
+
+    if(!IsTask(address)) return address;
+
+    return TaskNode(address)->task.getSource();
+
+}
+
+/*!
+ * Releases the given execution address without executing it.
+ * A queued Opal::Task is destroyed and a continuation destroys
+ * its' coroutine; plain execution addresses hold nothing.
+ * \param address The execution address
+ */
+
+void Opal::PathDeterminant::Discard(void* address) {
+
+#if __cpp_impl_coroutine
+
+    if(IsContinuation(address)) { std::coroutine_handle<>::from_address(ContinuationFrame(address)).destroy(); return; }
+
+#endif
+
+    if(!IsTask(address)) return;
+
+    Node* node = TaskNode(address);
+
+    node->owner->release(node);
+
+}
+
+/// --------------
+/// Public Methods
+
+/*!
+ * Pushes the given execution address to the highest priority.
+ * \param address The execution address
+ * \return Opal::Flag denoting if the address was pushed; false if
+ * the Opal::PathDeterminant is full.
+ */
+
+Opal::Flag Opal::PathDeterminant::push(void* address) {
+
+    uint32_t node = popFrom(available);
+
+    // No more room
+    if(!node) return false;
+
+    nodes[node - 1].address = address;
+    nodes[node - 1].queued  = stamping.load(std::memory_order_relaxed) ? Opal::Now() : 0;
+
+    pushOnto(pushed, node);
+
+    return true;
+
+}
+
+/*!
+ * Places the given execution address at the lowest priority.
+ * \param address The execution address
+ * \return Opal::Flag denoting if the address was placed; false if
+ * the Opal::PathDeterminant is full.
+ */
+
+Opal::Flag Opal::PathDeterminant::place(void* address) {
+
+    uint64_t position = placeIndex.load(std::memory_order_relaxed);
+    Cell*    cell     = 0;
+
+    while(true) {
+
+        cell = &cells[position & (Capacity - 1)];
+
+        int64_t difference = static_cast<int64_t>(cell->sequence.load(std::memory_order_acquire) - position);
+
+        // The cell is ready to be written; claim it
+        if(!difference) {
+
+            if(placeIndex.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+
+        }
+
+        // The cell still holds an address from the previous lap; we're full
+        else if(difference < 0) return false;
+
+        // Someone else claimed it; catch up
+        else position = placeIndex.load(std::memory_order_relaxed);
+
+    }
+
+    cell->address = address;
+    cell->queued  = stamping.load(std::memory_order_relaxed) ? Opal::Now() : 0;
+    cell->sequence.store(position + 1, std::memory_order_release);
+
+    return true;
+
+}
+
+/*!
+ * Pushes the given Opal::Task to the highest priority. The
+ * Opal::Task occupies the node it's pushed with.
+ * \param task The Opal::Task; left untouched if there's no room
+ * \return Opal::Flag denoting if the Opal::Task was pushed; false if
+ * the Opal::PathDeterminant is full.
+ */
+
+Opal::Flag Opal::PathDeterminant::push(Opal::Task&& task) {
+
+    uint32_t node = store(std::move(task));
+
+    // No more room
+    if(!node) return false;
+
+    nodes[node - 1].queued = stamping.load(std::memory_order_relaxed) ? Opal::Now() : 0;
+
+    pushOnto(pushed, node);
+
+    return true;
+
+}
+
+/*!
+ * Places the given Opal::Task at the lowest priority. The
+ * Opal::Task occupies a node while its' tag waits in the ring.
+ * \param task The Opal::Task; left untouched if there's no room
+ * \return Opal::Flag denoting if the Opal::Task was placed; false if
+ * the Opal::PathDeterminant is full.
+ */
+
+Opal::Flag Opal::PathDeterminant::place(Opal::Task&& task) {
+
+    uint32_t node = store(std::move(task));
+
+    // No more room
+    if(!node) return false;
+
+    if(place(nodes[node - 1].address)) return true;
+
+    // The ring is full; give the task back
+    task = std::move(nodes[node - 1].task);
+
+    release(&nodes[node - 1]);
+
+    return false;
+
+}
+
+/*!
+ * Removes and returns the highest priority execution address.
+ * Pushed execution addresses are returned before placed ones.
+ * A queued Opal::Task must be handed to Run() or Discard().
+ * \param queued Where the time the address was queued goes, if
+ * anywhere; zero if it wasn't stamped
+ * \return the execution address, or null if there is none.
+ */
+
+void* Opal::PathDeterminant::take(Opal::Nanoseconds* queued) {
+
+    // Pushed addresses have the highest priority
+    uint32_t node = popFrom(pushed);
+
+    if(node) {
+
+        void* address = nodes[node - 1].address;
+
+        if(queued) *queued = nodes[node - 1].queued;
+
+        // A task keeps its' node until it has run
+        if(!IsTask(address)) pushOnto(available, node);
+
+        return address;
+
+    }
+
+    uint64_t position = takeIndex.load(std::memory_order_relaxed);
+    Cell*    cell     = 0;
+
+    while(true) {
+
+        cell = &cells[position & (Capacity - 1)];
+
+        int64_t difference = static_cast<int64_t>(cell->sequence.load(std::memory_order_acquire) - (position + 1));
+
+        // The cell holds an address; claim it
+        if(!difference) {
+
+            if(takeIndex.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+
+        }
+
+        // The cell hasn't been written yet; we're empty
+        else if(difference < 0) return 0;
+
+        // Someone else claimed it; catch up
+        else position = takeIndex.load(std::memory_order_relaxed);
+
+    }
+
+    void* address = cell->address;
+
+    if(queued) *queued = cell->queued;
+
+    // Ready the cell for the next lap
+    cell->sequence.store(position + Capacity, std::memory_order_release);
+
+    return address;
+
+}
+
+/*!
+ * Sets whether execution addresses are stamped with the time they're
+ * queued at. Stamping costs a clock read per queued address.
+ * \param stamping Denotes if addresses are stamped
+ */
+
+void Opal::PathDeterminant::setStamping(Opal::Flag stamping) {
+
+    this->stamping.store(stamping, std::memory_order_relaxed);
+
+}
+
+/*!
+ * Returns a flag denoting if the Opal::PathDeterminant holds
+ * no execution addresses.
+ * \return Opal::Flag denoting if the Opal::PathDeterminant is empty
+ */
+
+Opal::Flag Opal::PathDeterminant::isEmpty() {
+
+    return !TaggedIndex(pushed.load(std::memory_order_acquire)) &&
+           placeIndex.load(std::memory_order_acquire) == takeIndex.load(std::memory_order_acquire);
+
+}
@@ -0,0 +1,260 @@
+/*!
+ * Opal::Placement implementation
+ *
+ * \author: Carlos L. Cuenca
+ */
+
+#include<cstdio>
+#include<cstring>
+#include<dirent.h>
+#include<linux/mempolicy.h>
+#include<sys/syscall.h>
+#include<unistd.h>
+#include<Placement.hpp>
+
+/// ------------------------
+/// Private Static Functions
+
+/*!
+ * Reads a single integer from the given topology file of the given cpu.
+ * \param cpu The cpu
+ * \param name The name of the file in the cpu's topology directory
+ * \return the value, or negative if it couldn't be read
+ */
+
+static int32_t TopologyOf(uint32_t cpu, const char* name) {
+
+    char path[128];
+
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/%s", cpu, name);
+
+    FILE* file = fopen(path, "r");
+
+    if(!file) return -1;
+
+    int32_t value = -1;
+
+    if(fscanf(file, "%d", &value) != 1) value = -1;
+
+    fclose(file);
+
+    return value;
+
+}
+
+/// ------------
+/// Constructors
+
+/*!
+ * Default Constructor. Leaves the thread and its' memory
+ * wherever they would have gone anyway.
+ */
+
+Opal::Placement::Placement(): cpus(), node(-1), pinned(false), stack(0) { CPU_ZERO(&cpus); }
+
+/*!
+ * Pins the thread to the given cpu and its' memory to the
+ * node the cpu belongs to.
+ * \param cpu The cpu to pin to
+ */
+
+Opal::Placement::Placement(uint32_t cpu): cpus(), node(NodeOf(cpu)), pinned(true), stack(0) {
+
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+
+}
+
+/*!
+ * Pins the thread to the given cpu set and its' memory to
+ * the given node.
+ * \param cpus The cpus the thread may run on
+ * \param node The NUMA node, negative for any
+ */
+
+Opal::Placement::Placement(const cpu_set_t& cpus, int32_t node): cpus(cpus), node(node), pinned(true), stack(0) { /* Empty */ }
+
+/// ----------------------
+/// Public Static Methods
+
+/*!
+ * Returns the NUMA node the given cpu belongs to. The kernel
+ * lists a 'node<n>' link in the cpu's directory.
+ * \param cpu The cpu
+ * \return the node, or negative if it couldn't be determined.
+ */
+
+int32_t Opal::Placement::NodeOf(uint32_t cpu) {
+
+    char path[64];
+
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u", cpu);
+
+    DIR* directory = opendir(path);
+
+    if(!directory) return -1;
+
+    int32_t node = -1;
+
+    for(struct dirent* entry = readdir(directory); entry && node < 0; entry = readdir(directory))
+        if(!strncmp(entry->d_name, "node", 4) && sscanf(entry->d_name + 4, "%d", &node) != 1) node = -1;
+
+    closedir(directory);
+
+    return node;
+
+}
+
+/*!
+ * Fills the given array with one Opal::Placement per physical
+ * core the invoking thread may run on; hyperthread siblings are
+ * skipped. Cores are ordered by node, so a prefix of the layout
+ * stays on as few nodes as possible. Without a readable topology,
+ * every allowed cpu counts as a core.
+ * \param placements The array to fill
+ * \param count The capacity of the array
+ * \return the amount of Opal::Placements written
+ */
+
+uint32_t Opal::Placement::PhysicalCores(Opal::Placement* placements, uint32_t count) {
+
+    cpu_set_t allowed;
+
+    if(!placements || sched_getaffinity(0, sizeof(allowed), &allowed)) return 0;
+
+    // The first cpu of each (package, core) pair we've seen
+    static const uint32_t MaximumCores = CPU_SETSIZE;
+
+    int32_t  packages[MaximumCores] ;
+    int32_t  cores[MaximumCores]    ;
+    int32_t  nodes[MaximumCores]    ;
+    uint32_t firsts[MaximumCores]   ;
+    uint32_t found = 0;
+
+    for(uint32_t cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+
+        if(!CPU_ISSET(cpu, &allowed)) continue;
+
+        int32_t package = TopologyOf(cpu, "physical_package_id");
+        int32_t core    = TopologyOf(cpu, "core_id");
+        uint32_t index  = 0;
+
+        // Unknown topology; don't fold it into anything
+        if(core >= 0) for(; index < found; index++)
+            if(packages[index] == package && cores[index] == core) break;
+
+        if(core >= 0 && index < found) continue;
+
+        packages[found] = package       ;
+        cores[found]    = core          ;
+        nodes[found]    = NodeOf(cpu)   ;
+        firsts[found]   = cpu           ;
+
+        found++;
+
+    }
+
+    // Lay them out node by node, keeping cpu order within a node
+    uint32_t written = 0;
+
+    for(int32_t node = -1; written < count && written < found; node++) {
+
+        for(uint32_t index = 0; index < found && written < count; index++)
+            if(nodes[index] == node) placements[written++] = Opal::Placement(firsts[index]);
+
+    }
+
+    return written;
+
+}
+
+/// --------------
+/// Public Methods
+
+/*!
+ * Restricts the given thread to the cpu set, if there is one.
+ * \param threadID The thread to restrict
+ * \return Opal::Flag denoting if the thread was restricted
+ */
+
+Opal::Flag Opal::Placement::apply(pid_t threadID) const {
+
+    return pinned && !sched_setaffinity(threadID, sizeof(cpus), &cpus);
+
+}
+
+/*!
+ * Prefers the node for the pages of the given range, moving the
+ * ones that are already somewhere else. Only whole pages inside
+ * the range are affected. Fails quietly on kernels without NUMA.
+ * \param address The start of the range
+ * \param size The size of the range in bytes
+ * \return Opal::Flag denoting if the policy was set
+ */
+
+Opal::Flag Opal::Placement::bind(void* address, uint64_t size) const {
+
+    static const uint64_t pageSize = sysconf(_SC_PAGESIZE);
+
+    if(node < 0 || !address) return false;
+
+    uint64_t start = (reinterpret_cast<uint64_t>(address) + pageSize - 1) & ~(pageSize - 1);
+    uint64_t end   = (reinterpret_cast<uint64_t>(address) + size) & ~(pageSize - 1);
+
+    if(end <= start) return false;
+
+    static const uint64_t MaskBits = 1024;
+
+    uint64_t mask[MaskBits / 64] = { 0 };
+
+    if(static_cast<uint64_t>(node) >= MaskBits) return false;
+
+    mask[node / 64] = 1ULL << (node % 64);
+
+    // The kernel wants one more than the amount of bits it may look at
+    return !syscall(SYS_mbind, start, end - start, MPOL_PREFERRED, mask, MaskBits + 1, MPOL_MF_MOVE);
+
+}
+
+/*!
+ * Returns a flag denoting if the Opal::Placement pins the thread.
+ * \return Opal::Flag denoting if the thread is pinned
+ */
+
+Opal::Flag Opal::Placement::isPinned() const { return pinned; }
+
+/*!
+ * Returns the NUMA node of the Opal::Placement.
+ * \return the node, or negative for any
+ */
+
+int32_t Opal::Placement::getNode() const { return node; }
+
+/*!
+ * Returns the cpus of the Opal::Placement.
+ * \return Reference to the cpu set
+ */
+
+const cpu_set_t& Opal::Placement::getCPUs() const { return cpus; }
+
+/*!
+ * Sets the STACK_* options the thread's stack is mapped with.
+ * Only takes effect for threads created afterwards.
+ * \param options The stack options
+ * \return Reference to the Opal::Placement
+ */
+
+Opal::Placement& Opal::Placement::setStackOptions(uint32_t options) {
+
+    stack = options;
+
+    return *this;
+
+}
+
+/*!
+ * Returns the STACK_* options the thread's stack is mapped with.
+ * \return the stack options
+ */
+
+uint32_t Opal::Placement::getStackOptions() const { return stack; }
@@ -4,7 +4,150 @@
  * \author: Carlos L. Cuenca
  */
 
+#include<linux/sched.h>
 #include<Saboteur.hpp>
+#include<GreenTask.hpp>
+
+/// -----------------
+/// Macro Definitions
+
+// Omit from documentation
+// What a system call interrupted by a stop returns until the kernel
+// restarts it; they never make it to user space otherwise. The last
+// one restarts from a block the kernel keeps per thread.
+#define ERESTARTSYS             512
+#define ERESTARTNOINTR          513
+#define ERESTARTNOHAND          514
+#define ERESTART_RESTARTBLOCK   516
+
+/// -----------
+/// Trampolines
+
+/*!
+ * The code a redirected Opal::Saboteur resumes at. Opal::Saboteur::Divert
+ * leaves the execution address on top of the interrupted stack, with
+ * the paths to drain after it (if any) above it, the interrupted
+ * instruction pointer above that and the interrupted red zone above
+ * that. The trampoline preserves every register the interrupted code
+ * could be relying on (including the vector state), calls the execution
+ * address, restores them and returns to the interrupted instruction.
+ */
+
+extern "C" void RedirectTrampoline();
+
+/*!
+ * Runs the execution address a handler took; called by the trampoline.
+ * A time slice also runs everything that's waiting in the paths before
+ * the interrupted code gets to continue.
+ * \param executionAddress The execution address
+ * \param paths The paths to drain afterwards, or null
+ */
+
+extern "C" __attribute__((used)) void RedirectRun(void* executionAddress, Opal::PathDeterminant* paths) {
+
+    Opal::PathDeterminant::Run(executionAddress);
+
+    if(paths) while((executionAddress = paths->take())) Opal::PathDeterminant::Run(executionAddress);
+
+}
+
+__asm__(
+    ".text                                  \n"
+    ".globl RedirectTrampoline              \n"
+    ".type  RedirectTrampoline, @function   \n"
+    "RedirectTrampoline:                    \n"
+    "   pushfq                              \n"
+    "   push    rax                         \n"
+    "   push    rcx                         \n"
+    "   push    rdx                         \n"
+    "   push    rsi                         \n"
+    "   push    rdi                         \n"
+    "   push    r8                          \n"
+    "   push    r9                          \n"
+    "   push    r10                         \n"
+    "   push    r11                         \n"
+    "   push    rbp                         \n"
+    "   mov     rbp, rsp                    \n"
+    "   and     rsp, -64                    \n"
+    "   sub     rsp, 4096                   \n"
+    // The xsave header has to be clear for xrstor
+    "   xor     eax, eax                    \n"
+    "   mov     [rsp + 512], rax            \n"
+    "   mov     [rsp + 520], rax            \n"
+    "   mov     [rsp + 528], rax            \n"
+    "   mov     [rsp + 536], rax            \n"
+    "   mov     [rsp + 544], rax            \n"
+    "   mov     [rsp + 552], rax            \n"
+    "   mov     [rsp + 560], rax            \n"
+    "   mov     [rsp + 568], rax            \n"
+    // x87, SSE, AVX and AVX-512 state
+    "   mov     eax, 0xe7                   \n"
+    "   xor     edx, edx                    \n"
+    "   xsave64 [rsp]                       \n"
+    "   cld                                 \n"
+    "   mov     rdi, [rbp + 88]             \n"
+    "   mov     rsi, [rbp + 96]             \n"
+    "   call    RedirectRun                 \n"
+    "   mov     eax, 0xe7                   \n"
+    "   xor     edx, edx                    \n"
+    "   xrstor64 [rsp]                      \n"
+    "   mov     rsp, rbp                    \n"
+    "   pop     rbp                         \n"
+    "   pop     r11                         \n"
+    "   pop     r10                         \n"
+    "   pop     r9                          \n"
+    "   pop     r8                          \n"
+    "   pop     rdi                         \n"
+    "   pop     rsi                         \n"
+    "   pop     rdx                         \n"
+    "   pop     rcx                         \n"
+    "   pop     rax                         \n"
+    "   popfq                               \n"
+    // Drop the execution address and the paths without touching the flags
+    "   lea     rsp, [rsp + 16]             \n"
+    // Return to the interrupted instruction, skipping the red zone
+    "   ret     128                         \n"
+    ".size RedirectTrampoline, .-RedirectTrampoline \n"
+);
+
+/*!
+ * Clones a thread with clone3 that invokes the given entry function
+ * with the given argument on the stack the arguments describe, and
+ * exits with what it returns. There's no libc wrapper to do this for
+ * us; the child comes out of the system call with the parent's
+ * registers on an empty stack.
+ * \param arguments The clone3 arguments
+ * \param size The size of the arguments
+ * \param entry The function the thread invokes
+ * \param argument The argument it's invoked with
+ * \return the thread id of the child, or a negated errno
+ */
+
+extern "C" int64_t Clone3(clone_args* arguments, uint64_t size, int (*entry)(void*), void* argument);
+
+__asm__(
+    ".text                                  \n"
+    ".globl Clone3                          \n"
+    ".type  Clone3, @function               \n"
+    "Clone3:                                \n"
+    // Everything but rcx and r11 survives the call, on both sides
+    "   mov     r8, rdx                     \n"
+    "   mov     r9, rcx                     \n"
+    "   mov     eax, 435                    \n"
+    "   syscall                             \n"
+    "   test    rax, rax                    \n"
+    "   jnz     1f                          \n"
+    // The child; nothing to return to, so the frame chain ends here
+    "   xor     ebp, ebp                    \n"
+    "   mov     rdi, r9                     \n"
+    "   call    r8                          \n"
+    "   mov     edi, eax                    \n"
+    "   mov     eax, 60                     \n"
+    "   syscall                             \n"
+    "   hlt                                 \n"
+    "1: ret                                 \n"
+    ".size Clone3, .-Clone3                 \n"
+);
 
 /// ----------------------------
 /// Static Member Initialization
@@ -95,6 +238,20 @@ const Opal::CloneFlags Opal::Saboteur::CloneFlags =
  CLONE_PARENT          | CLONE_PARENT_SETTID  | CLONE_SETTLS  | CLONE_SIGHAND |
  CLONE_SYSVSEM         | CLONE_THREAD         | CLONE_VM      | 0);
 
+const uint32_t Opal::Saboteur::DefaultSpinBudget = 1024;
+
+const uint64_t Opal::Saboteur::DefaultStackSize = 8 * 1024 * 1024;
+
+Opal::StackArena Opal::Saboteur::Stacks;
+
+const int Opal::Saboteur::RedirectSignal = SIGRTMIN + 1;
+
+const uint64_t Opal::Saboteur::SignalStackSize = 64 * 1024;
+
+const int Opal::Saboteur::SliceSignal = SIGRTMIN + 2;
+
+const uint64_t Opal::Saboteur::SliceHeadroom = 6 * 1024;
+
 /// ------------
 /// Constructors
 
@@ -103,14 +260,15 @@ const Opal::CloneFlags Opal::Saboteur::CloneFlags =
  * to its' default state.
  */
 
-Opal::Saboteur::Saboteur():
-executionAddress(0), observer(0), threadID(0),
-state(0), stack(), stackSize(), stateMutex() {
+Opal::Saboteur::Saboteur() {
+
+    // Lifecycle runs on the stack we hand it
+    this->stack = static_cast<uint64_t*>(Stacks.allocate(stackSize));
 
     //this->stack[513] = reinterpret_cast<uint64_t>(this)     ;
     //this->stack[512] = reinterpret_cast<uint64_t>(observer) ;
 
-    std::cout << "Stack: " << this->stack << std::endl;
+    TraceVerbose(trace, TRACE_CREATE, this->stack);
 
     this->stop = &kill; Lifecycle(this); }
 
@@ -119,22 +277,43 @@ state(0), stack(), stackSize(), stateMutex() {
  * to its' default state with the given Opal::SaboteurObserver.
  * \param observer The Opal::SaboteurObserver to bind to the
  * Opal::Saboteur
+ * \param stackSize The usable size of the stack in bytes
  */
 
-Opal::Saboteur::Saboteur(Opal::SaboteurObserver* observer):
-executionAddress(0), observer(observer), threadID(0),
-state(0), stack(), stackSize(), stateMutex() {
+Opal::Saboteur::Saboteur(Opal::SaboteurObserver* observer, uint64_t stackSize):
+stackSize(stackSize), observer(observer) {
 
     this->stop = &kill;
 
+    // Lifecycle runs on the stack we hand it
+    this->stack = static_cast<uint64_t*>(Stacks.allocate(stackSize));
+
      Lifecycle(this);
 
 }
 
+/*!
+ * Initializes the Opal::Saboteur and launches its' thread without
+ * waiting for it to stop. Only Spawn() constructs these, and settles
+ * them once every other thread in the batch is launched too.
+ * \param placement The cpus and NUMA node the Opal::Saboteur lives on
+ * \param observer The Opal::SaboteurObserver that receives callbacks
+ * from the Opal::Saboteur
+ * \param stackSize The usable size of the stack in bytes
+ */
+
+Opal::Saboteur::Saboteur(const Opal::Placement& placement, Opal::SaboteurObserver* observer, uint64_t stackSize):
+stackSize(stackSize), observer(observer), placement(placement) {
+
+    Launch(this);
+
+}
+
 /*!
  * Deconstructor. Releases any resources used by the Opal::Saboteur.
- * At the time of writing, no resources are used or released. The deconstructor
- * will make every attempt to gracefully terminate the Opal::Saboteur
+ * The stack is returned to the Opal::StackArena once the Opal::Saboteur
+ * has terminated. The deconstructor will make every attempt to
+ * gracefully terminate the Opal::Saboteur
  */
 
 Opal::Saboteur::~Saboteur() {
@@ -142,18 +321,37 @@ Opal::Saboteur::~Saboteur() {
     // Set the Opal::Saboteur's state to terminated if it's not attached
     //if(!isIn(ATTACHED)) setStateTo(TERMINATE);
 
-    // Relinquish the remaining cpu time as long as
-    // the thread has not terminated.
-    while(!isIn(TERMINATED)) Yield;
+    // A stopped thread can't see the terminate request or the wake
+    if(isIn(SUSPENDED)) Resume(this);
+
+    // Let the Opal::Saboteur know it should leave if it's parked
+    if(!isIn(TERMINATED)) terminate();
+
+    // Sleep until the thread is off the stack, even if it never
+    // made it to TERMINATED.
+    join();
+
+    // If we're the tracer, the exited thread waits on us to reap it;
+    // a detached thread isn't ours and this returns straight away.
+    if(threadID) waitpid(threadID, 0, __WALL);
+
+    // Reaped; anything still watching it lets go along with this
+    if(pidfd >= 0) close(pidfd);
 
-   // while(true) Yield;
+    Stacks.release(stack, stackSize, placement.getStackOptions());
+    Stacks.release(signalStack.load(), SignalStackSize);
 
-    std::cout << "Why" << std::endl;
+    delete eventRing.exchange(0);
+    delete counters.exchange(0);
+    delete[] histograms.exchange(0);
+
+    TraceState(trace, TRACE_DESTROY, threadID);
     // Clear out the thread state
     executionAddress  = 0     ;
     observer          = 0     ;
     threadID          = 0     ;
-    state             = 0     ;
+    stack             = 0     ;
+    state.store(CLEAR)      ;
 
 }
 
@@ -180,6 +378,11 @@ void Opal::Saboteur::Resume(Opal::Saboteur* thread) {
     if(ptrace(PTRACE_CONT, thread->threadID, 0, 0));
         //throw Opal::Saboteur::SaboteurResumeFailureException();
 
+    Opal::Nanoseconds resumingAt = thread->resumingAt.exchange(0, std::memory_order_relaxed);
+    Opal::Histogram*  histograms = thread->histograms.load(std::memory_order_acquire);
+
+    if(histograms && resumingAt) histograms[HISTOGRAM_RESUME].record(Now() - resumingAt);
+
 }
 
 /*!
@@ -205,469 +408,1623 @@ void Opal::Saboteur::Suspend(Opal::Saboteur* thread) {
 
 }
 
-struct Registers {
-
-    void*       base    ;
-    uint32_t    length  ;
+/*!
+ * Returns a flag denoting if the given Opal::State can
+ * be transitioned to from the current Opal::State. Nothing
+ * leaves the terminated state, only a suspended Opal::Saboteur
+ * resumes, the created state is the first state, and a terminating
+ * Opal::Saboteur can only be suspended or finish.
+ * \param current The Opal::State the Opal::Saboteur is in
+ * \param state The Opal::State to transition to
+ * \return Opal::Flag denoting if the transition is permitted
+ */
 
-};
+Opal::Flag Opal::Saboteur::IsTransition(Opal::State current, Opal::State state) {
 
-// Note: RIP on the test machine was index 4 (register 5), rbp was index 6 (register 7)
-//
-void* Opal::Saboteur::RegistersOf(Opal::Saboteur* thread) {
+    if(current == TERMINATED) return false;
 
-    // Leave if the Opal::Saboteur is null
-    if(!thread) return 0;
+    if(state == RESUMING) return current == SUSPENDED;
 
-    uint64_t* user_regs = new uint64_t[32];
+    if(state == CREATED) return current == CLEAR;
 
-    struct Registers* registers = new Registers { &user_regs, sizeof(user_regs) };
+    if(current == TERMINATE) return state == TERMINATED || state == SUSPENDED;
 
-    std::cout << "Retrieving Register Set" << std::endl;
-    std::cout << "Stopping Process" << std::endl;
+    return true;
 
-    // There's no guarantee the Opal::Saboteur is suspended, so
-    // we attempt an invocation.
-    Suspend(thread);
+}
 
-    // Retrieve the contents of the registers
-    ptrace(PTRACE_GETREGSET, thread->threadID, 1, registers);
+/*!
+ * Returns a flag denoting if the given Opal::State mask
+ * contains every bit of the given Opal::State.
+ * \param mask The combined Opal::State values
+ * \param state The Opal::State to look for
+ * \return Opal::Flag denoting if the state is part of the mask
+ */
 
-    std::cout << "Registers Retrieved. Returning register contents." << std::endl;
+Opal::Flag Opal::Saboteur::Matches(Opal::State mask, Opal::State state) {
 
-    // Return the contents
-    return (void*) registers;
+    return (mask & state) == state;
 
 }
 
-void Opal::Saboteur::SetRegistersOf(Opal::Saboteur* thread, void* registers) {
+/*!
+ * Parks the Opal::Saboteur until either an execution address
+ * is assigned or it is set to terminate. The Opal::Saboteur
+ * spins for its' spin budget before it sleeps on its' wake sequence.
+ * This function should only be invoked by the Opal::Saboteur itself.
+ * \param thread The Opal::Saboteur to park
+ */
 
-    // Leave if the Opal::Saboteur is null
-    if(!thread) return;
+void Opal::Saboteur::Park(Opal::Saboteur* thread) {
 
-    // There's no guarantee the Opal::Saboteur is suspended, so
-    // we attempt an invocation.
-    Suspend(thread);
+    // Any wake request from here on out changes the sequence,
+    // so the futex wait below can't miss it.
+    uint32_t sequence = thread->wakeSequence.load(std::memory_order_acquire);
 
-    std::cout << "Setting Registers." << std::endl;
+    // Spin for a little while; the work might be around the corner
+    for(uint32_t spin = 0; spin < thread->spinBudget; spin++) {
 
-    // Set the register contents
-    ptrace(PTRACE_SETREGSET, thread->threadID, 1, registers);
+        if(HasWork(thread)) return;
+
+        Pause;
+
+    }
+
+    // Check one last time before we go to sleep
+    if(HasWork(thread)) return;
+
+    // Let the wakers know we're asleep so they issue the system call
+    thread->parked.store(1);
+
+    // Sleep as long as the sequence hasn't changed
+    FutexWait(&thread->wakeSequence, sequence);
+
+    thread->parked.store(0);
 
-    std::cout << "Registers Set" << std::endl;
+    // Measure how long it took us to wake up, if we were woken
+    Opal::Nanoseconds unparkedAt = thread->unparkedAt.exchange(0);
+
+    if(unparkedAt) thread->wakeLatency.store(Now() - unparkedAt);
 
 }
 
 /*!
- * Creates the thread of execution and binds it to the given
- * Opal::Saboteur instance. This function ensures that a thread
- * is created, traced, and executed.
- * \param thread The Opal::Saboteur to bind
+ * Wakes the given Opal::Saboteur if it's parked. Only the
+ * given Opal::Saboteur is woken.
+ * \param thread The Opal::Saboteur to wake
  */
 
-void Opal::Saboteur::Create(Opal::Saboteur* thread) {
-
-    // This is our OS thread 'handle'.
-    uint32_t threadReference;
+void Opal::Saboteur::Unpark(Opal::Saboteur* thread) {
 
-    thread->stack = new uint64_t[1024*1024];
+    // Leave if the Opal::Saboteur is null
+    if(!thread) return;
 
-    std::cout << std::hex << thread << " With stack: " << thread->stack <<  std::endl;
+    // Invalidate the sequence the Opal::Saboteur might be about to sleep on
+    thread->wakeSequence.fetch_add(1);
 
-    int32_t stackSize = 1024*1024;
-    pid_t processId;
+    // Only issue the system call if someone is actually asleep
+    if(thread->parked.load()) {
 
-    std::cout << "Invoking clone" << std::endl;
-    if(clone(Opal::Saboteur::Execution, thread->stack + stackSize,
-             CLONE_PARENT_SETTID | CLONE_PARENT | CLONE_VM | CLONE_SIGHAND
-             | CLONE_FILES | CLONE_FS | CLONE_IO, (void*) thread, &processId) == -1) {
+        thread->unparkedAt.store(Now());
 
-        perror("Opal::Saboteur");
+        FutexWake(&thread->wakeSequence, 1);
 
     }
 
-    std::cout << "Attempting to trace thread." << std::endl;
-
-    if(ptrace(PTRACE_SEIZE, processId, NULL, NULL)) { perror("Failed Seize"); }
+}
 
-    std::cout << "Waiting" << std::endl;
+/*!
+ * Returns a flag denoting if the given Opal::Saboteur has
+ * something to do; an execution address of its' own, one it could
+ * steal from a sibling, or being set to terminate.
+ * \param thread The Opal::Saboteur to check
+ */
 
-    // Wait for the child process to stop itself in preparation
-    // for execution.
-    wait(0);
+Opal::Flag Opal::Saboteur::HasWork(Opal::Saboteur* thread) {
 
-    std::cout << "Child stopped. Resuming child" << std::endl;
+    if(!thread->paths.isEmpty() || !thread->greens.isEmpty() || !thread->demoted.isEmpty() ||
+       thread->deque.getSize() || thread->isIn(TERMINATE)) return true;
 
-    Resume(thread);
+    Opal::Saboteur** siblings = thread->siblings.load(std::memory_order_acquire);
 
-    std::cout << "Saboteur trace success!" << std::endl;
+    // Not stealing
+    if(!siblings) return false;
 
-    // Set the state
-    thread->setStateTo(CREATED);
+    for(uint32_t index = 0; index < thread->siblingCount; index++)
+        if(siblings[index]->deque.getSize()) return true;
 
-    std::cout << "Saboteur created." << std::endl;
+    return false;
 
 }
 
 /*!
- * The execution method of the Opal::Saboteur. Any Opal::Saboteur that's
- * in an intermediate state should execute here to determine the
- * next path of execution. This function expects a pointer to a
- * Opal::Saboteur, if it is null or invalid, a
- * Opal::Saboteur::LostSaboteurException is thrown. The function will
- * relinquish any remaining cpu time if either an error was thrown
- * when attempting to retrieve internal state information, or if
- * the Opal::Saboteur is in a incorrect state to continue.
- * \param arg_thread The Opal::Saboteur handle passed by the parent
- * process.
+ * Returns the next execution address the given Opal::Saboteur
+ * should execute. Its' own deque is drained first, oldest first, then
+ * its' paths, then its' green tasks. When stealing, a bounded batch of
+ * the paths' surplus moves to the deque where siblings can get to it,
+ * and an Opal::Saboteur with nothing of its' own steals from the top
+ * of a sibling's deque.
+ * This function should only be invoked by the Opal::Saboteur itself.
+ * \param thread The Opal::Saboteur looking for work
+ * \return the execution address, or null if there is none.
  */
 
-int/*Opal::ReturnCode*/ Opal::Saboteur::Execution(void* arg_thread) {
+void* Opal::Saboteur::Next(Opal::Saboteur* thread) {
 
-    std::cout << "Starting child" << std::endl;
+    thread->queuedAt = 0;
 
-    // Fatal error, missing thread handle, so throw an exception
-    if(!arg_thread) throw Opal::Saboteur::LostSaboteurException();
+    // Whatever we moved out last time was taken from the paths before
+    // anything still in them, so it goes first and in the same order.
+    // A failed steal only means a sibling got that one.
+    void* executionAddress = 0;
 
-    // Cast it as a saboteur
-    Opal::Saboteur* thread = (Opal::Saboteur*) arg_thread;
+    while(thread->deque.getSize())
+        if((executionAddress = thread->deque.steal(&thread->queuedAt))) return executionAddress;
 
-    std::cout << "Handle retrieved: "   << thread << std::endl;
-    std::cout << "Setting thread id."   << std::endl;
-    std::cout << "State: "              << thread->state << std::endl;
+    Opal::Saboteur** siblings = thread->siblings.load(std::memory_order_acquire);
 
-    // We don't want to stop the process
-    // to do the setup again after the thread has been created,
-    // so we wrap this stuff here
-    if(!thread->state) {
+    executionAddress = thread->paths.take(&thread->queuedAt);
 
-        uint64_t sysResult = 0;
-        GetProcessId(sysResult);
-        thread->threadID = sysResult;
+    // Green tasks only run once the paths are drained; they're never stolen
+    if(!executionAddress) {
 
-        std::cout << "Saboteur Id retrieved."             << std::endl;
-        Suspend(thread);
+        Opal::GreenTask* green = NextGreen(thread);
 
-        std::cout << "Request successful " << std::endl;
+        if(green) return Opal::PathDeterminant::Green(green);
 
     }
 
-    std::cout << std::hex << thread->threadID  <<  " Waiting" << std::endl;
+    // Not stealing, so there's nothing else to look at
+    if(!siblings) return executionAddress;
 
-    // Waiting state = No terminate and no execution address
-    // Both method invocations may throw an exception that indicate
-    // an undetermined state.
-    while(!(thread->setStateTo(WAITING).getExecutionAddress()) &&
-          !(thread->isIn(TERMINATE))) Yield;
+    if(executionAddress) {
 
-    std::cout << "Finished waiting" << std::endl;
+        // Move the rest where our siblings can steal it. Only we push
+        // to the deque, so the room we see can't shrink under us.
+        int64_t moved = 0;
 
-    // Started state = execution address, the terminate state
-    // is a don't-care
-    if(thread->getExecutionAddress()) {
+        while(moved < Opal::StealingDeque::Batch) {
 
-        // We're going to need this when we come back
-        Push(thread);
+            Opal::Nanoseconds queued  = 0;
+            void*             surplus = thread->paths.take(&queued);
 
-        std::cout << "Return address: " << Indirect(&Opal::Saboteur::Execution) << std::endl;
+            if(!surplus) break;
 
-        // Push the return address (here)
-        Push(Indirect(Opal::Saboteur::Execution));
+            thread->deque.push(surplus, queued);
 
-        // Set the state and execute the code.
-        Traverse(thread->setStateTo(STARTED).getExecutionAddress());
+            moved++;
 
-    }
-    std::cout << "Terminating" << std::endl;
-    // Otherwise, the thread is set to terminate, and there is no more
-    // code to execute. Remove the thread handle from the stack and
-    // set the thread to the corresponding state.
-    thread->setStateTo(TERMINATED);
+        }
 
-    // Leave
-    return 0;
+        // Let the next sibling know there's something to steal
+        if(moved && thread->siblingCount > 1)
+            Unpark(siblings[thread->victim++ % thread->siblingCount]);
 
-}
+        return executionAddress;
 
-/// ---------------
-/// Private Methods
+    }
 
-/*!
- * Checks the internal state for any matches of the given value.
- * If the value matches, then a corresponding exception is thrown.
- * \param state The Opal::State to check.
- */
+    // Nothing of our own; go through the siblings once
+    for(uint32_t attempt = 0; attempt < thread->siblingCount; attempt++) {
 
-void Opal::Saboteur::checkErrorState(Opal::State state) {
+        Opal::Saboteur* sibling = siblings[thread->victim++ % thread->siblingCount];
 
-    // Acquire the lock
-    Opal::Lock<Opal::Mutex> stateLock(stateMutex);
+        if(sibling == thread) continue;
 
-    // If the Opal::Saboteur is being swapped, throw a
-    // Opal::Saboteur::SaboteurIsSwappingException.
-    if(state & SWAPPING) throw Opal::Saboteur::SaboteurIsSwappingException();
+        if((executionAddress = sibling->deque.steal(&thread->queuedAt))) {
 
-    // Check if the process is finished
-    if(state & TERMINATED) throw Opal::Saboteur::SaboteurFinishedException();
+            thread->steals.fetch_add(1, std::memory_order_relaxed);
 
-    uint64_t sysResult = 0;GetProcessId(sysResult)
+            return executionAddress;
 
-    // Check thread id against the instances thread id here
-    // If the thread id's match, throw a Opal::Saboteur::SaboteurSwapSelfException
-    if(threadID == sysResult) throw Opal::Saboteur::SaboteurSwapSelfException();
+        }
 
-    // Check if the thread is calling this itself
-    if(threadID == sysResult)
-        throw Opal::Saboteur::SaboteurSuspendSelfException();
+    }
+
+    thread->stealFailures.fetch_add(1, std::memory_order_relaxed);
+
+    return 0;
 
 }
 
 /*!
- * Sets the current state of the Opal::Saboteur. If the Opal::Saboteur
- * has an observer, the Opal::Saboteur will notify it of the state
- * mutation.
- * \param state the Opal::State value to set.
+ * Returns the next green task the given Opal::Saboteur should resume.
+ * Ready green tasks go first; preempted ones only once none are ready,
+ * which also lets a preempted task finish a push the ready queue is
+ * waiting on.
+ * \param thread The Opal::Saboteur looking for a green task
+ * \return the green task, or null if there is none.
  */
 
-Opal::Saboteur& Opal::Saboteur::setStateTo(Opal::State state) {
-
-    // Acquire the lock
-    Opal::Lock<Opal::Mutex> stateLock(stateMutex);
+Opal::GreenTask* Opal::Saboteur::NextGreen(Opal::Saboteur* thread) {
 
-    if(this->state == state) return *this;
+    Opal::GreenQueue::Link* green = thread->greens.pop();
 
-    std::cout << "Setting State: " << std::hex << this->state << " to " << state << std::endl;
-    // Check if the Opal::Saboteur is resuming
-    if(!(state ^ RESUMING)) {
+    if(!green) green = thread->demoted.pop();
 
-        this->state = STARTED;
+    return static_cast<Opal::GreenTask*>(green);
 
-        if(observer)
-            observer->OnResume(Indirect(this));
-
-        return *this;
-
-    }
-
-    // This will clear the other flags and persist the appropriate
-    // flags.
-    this->state = state;
-
-    // Check if there's an observer to notify
-    if(observer) switch(state) {
+}
 
-        case CREATED    : observer->OnCreated(Indirect(this))   ; break;
+/*!
+ * Runs the given execution address on the given Opal::Saboteur. If
+ * it's being counted, the counters are read on either side of the run
+ * and the difference is attributed to where the address came from;
+ * the source is taken first, since running the address may release
+ * what it points at. Redirected addresses run on top of whatever they
+ * interrupted and count towards it.
+ * \param thread The Opal::Saboteur running the address
+ * \param executionAddress The execution address
+ */
 
-        case WAITING    : observer->OnWaiting(Indirect(this))   ; break;
+void Opal::Saboteur::Execute(Opal::Saboteur* thread, void* executionAddress) {
 
-        case STARTED    : observer->OnStarted(Indirect(this))   ; break;
+    Opal::Counters* counters = thread->counters.load(std::memory_order_acquire);
 
-        case SUSPENDED  : observer->OnSuspended(Indirect(this)) ; break;
+    if(Expect(!counters, 1)) { Opal::PathDeterminant::Run(executionAddress); return; }
 
-        case SUICIDE    : observer->OnSuicide(Indirect(this))   ; break;
+    void* source = Opal::PathDeterminant::Source(executionAddress);
 
-        case TERMINATED : observer->OnTerminated(Indirect(this)); break;
+    Opal::Counters::Sample before, after;
 
-        default: break;
+    Opal::Flag counted = counters->readSelf(before);
 
-    }
+    Opal::PathDeterminant::Run(executionAddress);
 
-    return *this;
+    if(counted && counters->readSelf(after)) counters->attribute(source, before, after);
 
 }
 
 /*!
- * Returns a Opal::Flag indicating if the Opal::Saboteur
- * is in the given state.
- * \param state The state to inspect
- * \return Opal::Flag denoting if the Opal::Saboteur is
- * in the given state.
+ * Gets the given Opal::Saboteur to execute its' highest priority
+ * execution address as soon as possible. Running code is preempted
+ * by the redirect signal; otherwise the address gets picked up once
+ * it's woken. Only for Opal::Saboteurs in REDIRECT_SIGNAL mode.
+ * \param thread The Opal::Saboteur to preempt
  */
 
-Opal::Flag Opal::Saboteur::isIn(Opal::State state) {
+void Opal::Saboteur::Preempt(Opal::Saboteur* thread) {
 
-    // Acquire the lock
-    Opal::Lock<Opal::Mutex> stateLock(stateMutex);
+    // Waiting; the address gets picked up once it's woken
+    if(!thread->isIn(STARTED)) { Unpark(thread); return; }
 
-    // Return the masked state
-    return !(this->state ^ state);
+    siginfo_t information = {};
+
+    information.si_signo            = RedirectSignal ;
+    information.si_code             = SI_QUEUE       ;
+    information.si_pid              = getpid()       ;
+    information.si_uid              = getuid()       ;
+    information.si_value.sival_ptr  = thread         ;
+
+    if(syscall(SYS_rt_tgsigqueueinfo, thread->threadID, thread->threadID, RedirectSignal, &information))
+        TraceError(thread->trace, TRACE_ERROR, errno);
+
+    // In case it went back to waiting in the meantime
+    Unpark(thread);
 
 }
 
 /*!
- * Returns the value of the last address the Opal::Saboteur
- * resumed execution or will continue execution from a suspended
- * state. This value is updated when either the link data is swapped
- * or the Opal::Saboteur is suspended. This method will check the
- * internal state of the Opal::Saboteur for a SWAPPING state, and
- * if it matches, it will throw a Opal::Saboteur::SaboteurIsSwappingException.
- * \return void pointer representing the address of the last
- * address the Opal::Saboteur resumed execution, or will resume
- * execution from a suspended state.
+ * Installs the redirect and time slice signal handlers. Returns zero
+ * on success. This function is invoked once, by the first
+ * Opal::Saboteur that's set to REDIRECT_SIGNAL.
  */
 
-void* Opal::Saboteur::getExecutionAddress() {
+int Opal::Saboteur::InstallRedirect() {
 
-    // Otherwise, return the value.
-    return executionAddress;
+    struct sigaction action = {};
 
-}
+    // The handlers run on the Opal::Saboteur's alternate stack so they
+    // never land where they're about to write, and never interrupt
+    // each other.
+    action.sa_sigaction = &Opal::Saboteur::Redirect;
+    action.sa_flags     = SA_SIGINFO | SA_ONSTACK | SA_RESTART;
 
-/*!
- * Replaces the current executing code with the given code.
- * The Opal::Saboteur must be suspended before retrieving
- * results.
- * \param executionAddress The address of the instruction
- * to replace.
- */
+    sigemptyset(&action.sa_mask);
+    sigaddset(&action.sa_mask, RedirectSignal);
+    sigaddset(&action.sa_mask, SliceSignal);
 
-void Opal::Saboteur::setExecutionAddress(void* executionAddress) { /* Empty */ }
+    if(sigaction(RedirectSignal, &action, 0)) return -1;
 
-/// --------------
-/// Public Methods
+    action.sa_sigaction = &Opal::Saboteur::Slice;
+
+    return sigaction(SliceSignal, &action, 0);
+
+}
 
 /*!
- * Swaps the Opal::Saboteur's resume and return
- * address and returns the previous resume and return address
- * as contained in a Opal::Saboteur::Link instance. This
- * method interrupts the Opal::Saboteur, preserves the current
- * state of the data, sets the new data, and returns
- * a copy of the previous data. Important. This method should be invoked
- * only by another thread, never the thread that corresponds with
- * the Opal::Saboteur instance otherwise a Opal::Saboteur::SaboteurSwapSelf
- * exception is thrown. If this method is invoked while the Opal::Saboteur
- * is in its' finished state, it will throw a Opal::Saboteur::SaboteurFinishedException.
- * \param The execution address to swap with the current execution address.
- * \param resume Opal::Flag denoting if the thread should continue execution
- * after swapping the execution address.
- * \return previous execution address
+ * Installs the given Opal::Saboteur's alternate signal stack if it
+ * has been handed one since the last time. This function should
+ * only be invoked by the Opal::Saboteur itself.
+ * \param thread The Opal::Saboteur to install the stack for
  */
 
-void* Opal::Saboteur::swap(void* executionAddress, Opal::Flag resume) {
+void Opal::Saboteur::InstallSignalStack(Opal::Saboteur* thread) {
 
-    // Check for terminated, self swap, self suspend, and suicide
-    checkErrorState(TERMINATED | SELF_SWAP | SELF_SUSPEND | SUICIDE);
+    uint8_t* signalStack = thread->signalStack.load(std::memory_order_acquire);
 
-    // If the Opal::Saboteur is not suspended, suspend it.
-    if(!isIn(SUSPENDED)) Suspend(this);
+    // Nothing new
+    if(Expect(signalStack == thread->installedStack, 1)) return;
 
-    // Get the previous execution address
-    void* previous = getExecutionAddress();
+    stack_t alternate = {};
 
-    // Overwrite the current execution address.
-    setExecutionAddress(executionAddress);
+    alternate.ss_sp     = signalStack;
+    alternate.ss_size   = SignalStackSize;
 
-    // Resume execution
-    if(resume) Resume(this);
+    if(sigaltstack(&alternate, 0)) { TraceError(thread->trace, TRACE_ERROR, errno); return; }
 
-    // Finally, return the previous data
-    return previous;
+    thread->installedStack = signalStack;
 
 }
 
 /*!
- * Pushes the given execution address to the highest priority (current)
- * position, effectively holding off on executing the code
- * that was being executed at the time of invocation, if
- * the Opal::Saboteur was executing. This method will
- * suspend the Opal::Saboteur.
- * \param executionAddress The execution address to push
- * \param resume Opal::Flag denoting if the Opal::Saboteur
- * should be resumed after the completion of the operation.
+ * Arms the given Opal::Saboteur's cpu time timer with its' time slice
+ * if it has changed since the last time. The timer is created by the
+ * Opal::Saboteur itself the first time around, so it measures the
+ * Opal::Saboteur's own cpu time and signals the Opal::Saboteur alone.
+ * It goes off once every slice of cpu time, whatever is running.
+ * \param thread The Opal::Saboteur to arm the timer for
  */
 
-void Opal::Saboteur::push(void* executionAddress, Opal::Flag resume) {
+void Opal::Saboteur::InstallTimeSlice(Opal::Saboteur* thread) {
 
-    // Ideally we:
-    // 1. Get the register contents of the Opal::Saboteur
-    // 2. Extract the value of the rip
-    // 3. Update the PathDeterminant with the record corresponding with the execution
-    // 4. Create a new record with the given execution address
-    // 5. Update the Opal::Saboteur's rip register with the execution address
-    // 6. Resume the thread.
-    // This is all fine and dandy when the thread is executing, but when the Opal::Saboteur
-    // is in a waiting state, we simply acquire a state lock and push the new execution address
-    // onto the PathDeterminant. Why? Because we want Opal::Saboteur::Execution to be pushed
-    // onto the stack in case execution of code is completed and the thread goes back to
-    // its' waiting state.
+    Opal::Nanoseconds slice = thread->timeSlice.load(std::memory_order_acquire);
 
-    // Throw an error if this thread invokes this function
-    std::cout << "Pushing execution address" << std::endl;
+    // Nothing new
+    if(Expect(slice == thread->armedSlice, 1)) return;
 
-    // Retrieve the register set
-    void* registers = RegistersOf(this);
+    if(thread->sliceTimer < 0) {
 
-    std::cout << "Setting rip" << std::endl;
+        struct sigevent event = {};
 
-    // Grab the RIP and update the latest record in the PathDeterminant.
+        event.sigev_notify          = SIGEV_THREAD_ID   ;
+        event.sigev_signo           = SliceSignal       ;
+        event.sigev_value.sival_ptr = thread            ;
+        event._sigev_un._tid        = syscall(SYS_gettid);
 
-    // Push the given execution address to the front so it can be
-    // executed immediately. This will cause the Opal::Saboteur
-    // to execute as soon as its' resumed since it's either in its'
-    // waiting state (It will transition to starting) or its' running.
-    // Before we leave, we check for those states and update the instruction
-    // register if it's in a running state so it can execute where we
-    // specified. Important caveat: This is where we would be update
-    // the activation records for each process.
+        if(syscall(SYS_timer_create, CLOCK_THREAD_CPUTIME_ID, &event, &thread->sliceTimer)) {
 
-    // Check the thread's state first; If it's waiting, we only update the
-    // PathDeterminant. No mutex since the Opal::Saboteur is suspended
-    if(isIn(WAITING) || true) {
+            TraceError(thread->trace, TRACE_ERROR, errno);
 
-        // Note to self: Store previous state before suspension.
-        std::cout << "Setting execution address" << std::endl;
+            thread->sliceTimer = -1;
 
-        this->executionAddress = executionAddress;
+            return;
 
-        std::cout << this->executionAddress << std::endl;
+        }
 
     }
 
-    else {
+    struct itimerspec period = {};
 
-        // Set the rip register to the code that should be executed.
-        ((uint64_t**) (((Registers*) registers)->base))[4] = (uint64_t*) executionAddress;
+    period.it_value.tv_sec      = slice / 1000000000;
+    period.it_value.tv_nsec     = slice % 1000000000;
+    period.it_interval          = period.it_value;
 
-        std::cout << "Set rip: " << ((uint64_t**) (((Registers*) registers)->base))[4] <<  std::endl;
+    if(syscall(SYS_timer_settime, thread->sliceTimer, 0, &period, 0)) { TraceError(thread->trace, TRACE_ERROR, errno); return; }
 
-        // Set the registers after modification.
-        SetRegistersOf(this, registers);
+    thread->armedSlice = slice;
 
-    }
+}
+
+/*!
+ * Rewrites the given interrupted context so it calls the given
+ * execution address through the trampoline as soon as the handler
+ * returns, and continues where it was interrupted once it returns.
+ * \param context The interrupted context
+ * \param executionAddress The execution address to call
+ * \param paths The paths to drain before continuing, or null
+ */
+
+void Opal::Saboteur::Divert(void* context, void* executionAddress, Opal::PathDeterminant* paths) {
+
+    greg_t*   registers = static_cast<ucontext_t*>(context)->uc_mcontext.gregs;
+    uint64_t* top       = reinterpret_cast<uint64_t*>(registers[REG_RSP] - 128) - 3;
+
+    // Leave the red zone alone, stash the interrupted instruction
+    // pointer, the paths and the execution address for the trampoline
+    top[2] = registers[REG_RIP];
+    top[1] = reinterpret_cast<uint64_t>(paths);
+    top[0] = reinterpret_cast<uint64_t>(executionAddress);
+
+    registers[REG_RSP] = reinterpret_cast<greg_t>(top);
+    registers[REG_RIP] = reinterpret_cast<greg_t>(&RedirectTrampoline);
+
+}
+
+/*!
+ * The redirect signal handler. Takes the highest priority execution
+ * address and rewrites the interrupted context so the address is
+ * called as soon as the handler returns. The interrupted context
+ * continues once the call returns, with its' registers intact.
+ * \param signal The redirect signal
+ * \param information The signal information; carries the Opal::Saboteur
+ * \param context The interrupted context
+ */
+
+void Opal::Saboteur::Redirect(int signal, siginfo_t* information, void* context) {
+
+    // Only our own queued signals carry an Opal::Saboteur
+    if(signal != RedirectSignal || information->si_code != SI_QUEUE) return;
+
+    Opal::Saboteur* thread = static_cast<Opal::Saboteur*>(information->si_value.sival_ptr);
+
+    uint8_t marker = 0;
+
+    // If we're not on the alternate stack, we're sitting right below the
+    // interrupted stack pointer; leave the address for Execution to find.
+    if(!thread || &marker < thread->installedStack || &marker >= thread->installedStack + SignalStackSize) return;
+
+    greg_t*   registers = static_cast<ucontext_t*>(context)->uc_mcontext.gregs;
+    uint8_t*  stack     = reinterpret_cast<uint8_t*>(thread->stack);
+
+    // A green task was interrupted; its' stack is too small to run
+    // anything else on, so Execution picks the address up instead.
+    if(reinterpret_cast<uint8_t*>(registers[REG_RSP]) < stack ||
+       reinterpret_cast<uint8_t*>(registers[REG_RSP]) >= stack + thread->stackSize) return;
+
+    void* executionAddress = thread->paths.take();
+
+    // Someone got to it first
+    if(!executionAddress) return;
+
+    Divert(context, executionAddress, 0);
+
+}
+
+/*!
+ * The time slice signal handler. Preempts whatever the Opal::Saboteur
+ * is running if something is waiting behind it. An interrupted green
+ * task is made to switch out as soon as the handler returns, and is
+ * queued behind the green tasks that are ready. Anything else has
+ * everything waiting in the paths run on top of it, the same way a
+ * redirect runs one execution address; the interrupted code continues
+ * once the paths are empty.
+ * \param signal The time slice signal
+ * \param information The signal information; carries the Opal::Saboteur
+ * \param context The interrupted context
+ */
+
+void Opal::Saboteur::Slice(int signal, siginfo_t* information, void* context) {
+
+    // Only our own timers carry an Opal::Saboteur
+    if(signal != SliceSignal || information->si_code != SI_TIMER) return;
+
+    Opal::Saboteur* thread = static_cast<Opal::Saboteur*>(information->si_value.sival_ptr);
+
+    uint8_t marker = 0;
+
+    // Same as a redirect; nothing to preempt unless we're on the
+    // alternate stack and the Opal::Saboteur is executing
+    if(!thread || &marker < thread->installedStack || &marker >= thread->installedStack + SignalStackSize) return;
+
+    if(!thread->isIn(STARTED)) return;
+
+    greg_t*   registers = static_cast<ucontext_t*>(context)->uc_mcontext.gregs;
+    uint8_t*  pointer   = reinterpret_cast<uint8_t*>(registers[REG_RSP]);
+    uint8_t*  stack     = reinterpret_cast<uint8_t*>(thread->stack);
+
+    // Its' own stack; whatever's running has the paths drained on top
+    // of it, as long as there's room. Green tasks wait for it to return;
+    // their queue can only be popped from outside a handler.
+    if(pointer >= stack && pointer < stack + thread->stackSize) {
+
+        if(static_cast<uint64_t>(pointer - stack) < SliceHeadroom) return;
+
+        void* executionAddress = thread->paths.take();
+
+        if(!executionAddress) return;
+
+        thread->preemptions.fetch_add(1, std::memory_order_relaxed);
+
+        Divert(context, executionAddress, &thread->paths);
+
+        return;
+
+    }
+
+    // Anywhere else is a green stack; switch out if anything is waiting
+    // and there's room for the trampoline below the interrupted frame
+    if(thread->paths.isEmpty() && thread->greens.isEmpty() && thread->demoted.isEmpty()) return;
+
+    if((reinterpret_cast<uint64_t>(pointer) & (Opal::GreenTask::StackSize - 1)) < SliceHeadroom) return;
+
+    thread->preemptions.fetch_add(1, std::memory_order_relaxed);
+
+    Divert(context, reinterpret_cast<void*>(&Opal::GreenTask::Preempt), 0);
+
+}
+
+/*!
+ * Stops the given Opal::Saboteur if it isn't already and reads its'
+ * registers into its' snapshot. Must be invoked by the thread that
+ * created the Opal::Saboteur.
+ * \param thread The Opal::Saboteur to read
+ * \return Pointer to the snapshot, or null if the registers couldn't be read
+ */
+
+Opal::Registers* Opal::Saboteur::RegistersOf(Opal::Saboteur* thread) {
+
+    // Leave if the Opal::Saboteur is null
+    if(!thread) return 0;
+
+    TraceVerbose(thread->trace, TRACE_REGISTERS, thread->threadID);
+
+    // The registers can only be read from a stopped thread, so
+    // make sure it actually stopped.
+    if(!thread->isIn(SUSPENDED)) SuspendAll(&thread, 1);
+
+    if(!thread->isIn(SUSPENDED)) return 0;
+
+    // Retrieve the contents of the registers
+    if(ptrace(PTRACE_GETREGSET, thread->threadID, NT_PRSTATUS, thread->registers.getVector())) {
+
+        TraceError(thread->trace, TRACE_ERROR, errno);
+
+        return 0;
+
+    }
+
+    return &thread->registers;
+
+}
+
+/*!
+ * Writes the given Opal::Saboteur's snapshot back to its' registers.
+ * The Opal::Saboteur must have been stopped by RegistersOf.
+ * \param thread The Opal::Saboteur to write
+ * \return Opal::Flag denoting if the registers were written
+ */
+
+Opal::Flag Opal::Saboteur::SetRegistersOf(Opal::Saboteur* thread) {
+
+    // Leave if the Opal::Saboteur is null or running
+    if(!thread || !thread->isIn(SUSPENDED)) return false;
+
+    TraceVerbose(thread->trace, TRACE_REGISTERS, thread->threadID);
+
+    // Set the register contents
+    if(ptrace(PTRACE_SETREGSET, thread->threadID, NT_PRSTATUS, thread->registers.getVector())) {
+
+        TraceError(thread->trace, TRACE_ERROR, errno);
+
+        return false;
+
+    }
+
+    return true;
+
+}
+
+/*!
+ * Creates the thread of execution and binds it to the given
+ * Opal::Saboteur instance. This function ensures that a thread
+ * is created, traced, and executed.
+ * \param thread The Opal::Saboteur to bind
+ */
+
+void Opal::Saboteur::Create(Opal::Saboteur* thread) {
+
+    Launch(thread);
+    Settle(thread);
+
+}
+
+/*!
+ * Allocates the stack of the given Opal::Saboteur, clones its' thread
+ * and seizes it. The thread is asked to stop so we know the trace
+ * took, but its' stop is left for Settle() to reap; a batch of them
+ * gets to start up at once.
+ * \param thread The Opal::Saboteur to launch
+ * \throws SaboteurCreateFailureException if the thread couldn't be created.
+ */
+
+void Opal::Saboteur::Launch(Opal::Saboteur* thread) {
+
+    thread->stack = static_cast<uint64_t*>(Stacks.allocate(thread->stackSize, thread->placement.getStackOptions()));
+
+    // Nothing to run on
+    if(!thread->stack) throw Opal::Saboteur::SaboteurCreateFailureException();
+
+    TraceState(thread->trace, TRACE_CREATE, thread->stack);
+
+    // Before anything touches it; clone itself writes to the top
+    thread->placement.bind(thread->stack, thread->stackSize);
+
+    // Set the state before the thread exists, so the observer
+    // hears about the creation before anything else.
+    thread->setStateTo(CREATED);
+
+    // This is our OS thread 'handle'. The kernel sets it before clone
+    // returns and clears it once the thread has exited.
+    pid_t* threadReference = reinterpret_cast<pid_t*>(&thread->childID);
+
+    const uint64_t flags = CLONE_PARENT_SETTID | CLONE_CHILD_CLEARTID | CLONE_PARENT | CLONE_VM | CLONE_SIGHAND
+                         | CLONE_FILES | CLONE_FS | CLONE_IO;
+
+    clone_args arguments;
+
+    memset(&arguments, 0, sizeof(arguments));
+
+    // The pidfd comes with the thread, so there's no window where
+    // its' id could be reused before we've got hold of it
+    arguments.flags      = flags | CLONE_PIDFD;
+    arguments.pidfd      = reinterpret_cast<uint64_t>(&thread->pidfd);
+    arguments.child_tid  = reinterpret_cast<uint64_t>(threadReference);
+    arguments.parent_tid = reinterpret_cast<uint64_t>(threadReference);
+    arguments.stack      = reinterpret_cast<uint64_t>(thread->stack);
+    arguments.stack_size = thread->stackSize;
+
+    int64_t result = Clone3(&arguments, sizeof(arguments), Opal::Saboteur::Execution, thread);
+
+    // Kernels without clone3, or filters that turn it away; the thread
+    // is still ours and isn't running anything yet, so its' id is safe
+    if(result == -ENOSYS || result == -EPERM) {
+
+        result = clone(Opal::Saboteur::Execution, reinterpret_cast<uint8_t*>(thread->stack) + thread->stackSize,
+                       static_cast<int>(flags), (void*) thread, threadReference, 0, threadReference);
+
+        if(result > 0) thread->pidfd = syscall(SYS_pidfd_open, result, 0);
+
+    }
+
+    // The fallback reports through errno, clone3 through the result
+    if(result < 0) {
+
+        TraceError(thread->trace, TRACE_ERROR, result == -1 ? errno : -result);
+
+        Stacks.release(thread->stack, thread->stackSize, thread->placement.getStackOptions());
+
+        thread->stack = 0;
+
+        throw Opal::Saboteur::SaboteurCreateFailureException();
+
+    }
+
+    pid_t processId = thread->childID.load();
+
+    // We need this before the thread gets around to it
+    thread->threadID = processId;
+
+    // It hasn't run anything of ours yet; move it where it belongs
+    thread->placement.apply(processId);
+
+    TraceVerbose(thread->trace, TRACE_CLONE, processId);
+
+    if(ptrace(PTRACE_SEIZE, processId, NULL, NULL)) { TraceError(thread->trace, TRACE_ERROR, errno); }
+
+    TraceVerbose(thread->trace, TRACE_SEIZE, processId);
+
+    ptrace(PTRACE_INTERRUPT, processId, NULL, NULL);
+
+}
+
+/*!
+ * Reaps the first stop of the given launched Opal::Saboteur and resumes
+ * it. Only its' own stop is waited on, so other threads spawning at
+ * the same time don't reap each other's. A signal that beats the
+ * interrupt here is delivered, as SuspendAll does.
+ * \param thread The Opal::Saboteur to settle
+ */
+
+void Opal::Saboteur::Settle(Opal::Saboteur* thread) {
+
+    while(true) {
+
+        siginfo_t information = {};
+
+        if(waitid(P_PID, thread->threadID, &information, WSTOPPED | WEXITED | __WALL)) {
+
+            // Interrupted by one of our own signals; keep waiting
+            if(errno == EINTR) continue;
+
+            TraceError(thread->trace, TRACE_ERROR, errno);
+
+            break;
+
+        }
+
+        // Gone; nothing to resume
+        if(information.si_code != CLD_TRAPPED && information.si_code != CLD_STOPPED) return;
+
+        if((information.si_status >> 8) == PTRACE_EVENT_STOP) break;
+
+        ptrace(PTRACE_CONT, thread->threadID, 0, information.si_status);
+
+    }
+
+    Resume(thread);
+
+}
+
+/*!
+ * The execution method of the Opal::Saboteur. Any Opal::Saboteur that's
+ * in an intermediate state should execute here to determine the
+ * next path of execution. This function expects a pointer to a
+ * Opal::Saboteur, if it is null or invalid, a
+ * Opal::Saboteur::LostSaboteurException is thrown. The function will
+ * relinquish any remaining cpu time if either an error was thrown
+ * when attempting to retrieve internal state information, or if
+ * the Opal::Saboteur is in a incorrect state to continue.
+ * \param arg_thread The Opal::Saboteur handle passed by the parent
+ * process.
+ */
+
+int/*Opal::ReturnCode*/ Opal::Saboteur::Execution(void* arg_thread) {
+
+    // Fatal error, missing thread handle, so throw an exception
+    if(!arg_thread) throw Opal::Saboteur::LostSaboteurException();
+
+    // Cast it as a saboteur
+    Opal::Saboteur* thread = (Opal::Saboteur*) arg_thread;
+
+    // We don't want to stop the process
+    // to do the setup again after the thread has been created,
+    // so we wrap this stuff here
+    if(thread->isIn(CREATED)) {
+
+        uint64_t sysResult = 0;
+        GetProcessId(sysResult);
+        thread->threadID = sysResult;
+
+        Suspend(thread);
+
+    }
+
+    TraceVerbose(thread->trace, TRACE_WAITING, thread->threadID);
+
+    void* executionAddress = 0;
+
+    while(true) {
+
+        // Waiting state = No terminate and no execution address
+        // Both method invocations may throw an exception that indicate
+        // an undetermined state.
+        thread->setStateTo(WAITING);
+
+        InstallSignalStack(thread);
+        InstallTimeSlice(thread);
+
+        while(!(executionAddress = Next(thread)) &&
+              !(thread->isIn(TERMINATE))) { Park(thread); InstallSignalStack(thread); InstallTimeSlice(thread); }
+
+        // Nothing left to execute and we're set to terminate
+        if(!executionAddress) break;
+
+        // Started state = execution address, the terminate state
+        // is a don't-care
+        thread->executionAddress = executionAddress;
+
+        TraceState(thread->trace, TRACE_EXECUTE, executionAddress);
+
+        // Set the state and execute the code in a frame of its' own.
+        // We come back here for the next execution address once it returns.
+        Execute(thread, thread->setStateTo(STARTED).getExecutionAddress());
+
+        // Green tasks hand over to each other without going back to
+        // waiting, as long as nothing else is queued behind them
+        while(Opal::PathDeterminant::IsGreen(executionAddress) && thread->paths.isEmpty() && !thread->deque.getSize()) {
+
+            Opal::GreenTask* green = NextGreen(thread);
+
+            if(!green) break;
+
+            thread->executionAddress = executionAddress = Opal::PathDeterminant::Green(green);
+
+            Execute(thread, executionAddress);
+
+        }
+
+        thread->executionAddress = 0;
+
+    }
+
+    TraceState(thread->trace, TRACE_TERMINATING, thread->threadID);
+
+    // The timer would outlive us otherwise
+    if(thread->sliceTimer >= 0) syscall(SYS_timer_delete, thread->sliceTimer);
+
+    // Otherwise, the thread is set to terminate, and there is no more
+    // code to execute. Remove the thread handle from the stack and
+    // set the thread to the corresponding state.
+    thread->setStateTo(TERMINATED);
+
+    // Leave
+    return 0;
+
+}
+
+/// -----------------------
+/// Public Static Functions
+
+/*!
+ * Creates the given amount of Opal::Saboteurs into the given group.
+ * Every thread is cloned, seized and interrupted before any first stop
+ * is reaped; the kernel starts them up while we're still cloning the
+ * rest, instead of each one waiting on the last. Any number of threads
+ * may spawn at once; each only reaps the stops of the threads it cloned,
+ * and traces them from then on. If a thread can't be created, the ones
+ * before it are still settled, so none are left stopped.
+ * \param group Where the Opal::Saboteurs go
+ * \param count The amount of Opal::Saboteurs to create
+ * \param observer The Opal::SaboteurObserver of every Opal::Saboteur
+ * \param stackSize The usable size of each stack in bytes
+ * \param placements The placement of each Opal::Saboteur, or null
+ * \throws SaboteurCreateFailureException if a thread couldn't be
+ * created; the ones before it are created, the rest are null.
+ */
+
+void Opal::Saboteur::Spawn(Opal::Saboteur** group, uint32_t count, Opal::SaboteurObserver* observer,
+                           uint64_t stackSize, const Opal::Placement* placements) {
+
+    uint32_t launched = 0;
+
+    try {
+
+        for(; launched < count; launched++)
+            group[launched] = new Opal::Saboteur(placements ? placements[launched] : Opal::Placement(), observer, stackSize);
+
+    } catch(...) {
+
+        for(uint32_t index = 0; index < launched; index++) Settle(group[index]);
+
+        for(uint32_t index = launched; index < count; index++) group[index] = 0;
+
+        throw;
+
+    }
+
+    for(uint32_t index = 0; index < count; index++) Settle(group[index]);
+
+}
+
+/*!
+ * Stops every Opal::Saboteur in the given group. Every member is
+ * interrupted before any stop is reaped, so the members stop
+ * concurrently; this returns only once each member that was
+ * interrupted has reported its' stop (or exit). Members in
+ * REDIRECT_SIGNAL mode aren't traced, so they're skipped, as is any
+ * member the interrupt didn't reach. Must be invoked by the thread
+ * that created the group, since that's the thread tracing them.
+ * \param group The Opal::Saboteurs to stop
+ * \param count The amount of Opal::Saboteurs in the group
+ * \param stopped Where the amount of members that are stopped on
+ * return goes, if anywhere; those already suspended included
+ * \return Opal::Nanoseconds between the first interrupt and the last stop
+ */
+
+Opal::Nanoseconds Opal::Saboteur::SuspendAll(Opal::Saboteur** group, uint32_t count, uint32_t* stopped) {
+
+    Opal::Nanoseconds start       = Now();
+    Opal::Flag*       interrupted = new Opal::Flag[count]();
+
+    // Interrupt everyone first; nobody waits on anybody else's stop
+    for(uint32_t index = 0; index < count; index++) {
+
+        Opal::Saboteur* thread = group[index];
+
+        if(!thread->threadID || thread->isIn(TERMINATED) || thread->isIn(SUSPENDED)) continue;
+
+        // Detached; there's no stop for us to reap
+        if(thread->redirectMode.load(std::memory_order_acquire) == REDIRECT_SIGNAL) continue;
+
+        if(thread->histograms.load(std::memory_order_relaxed)) thread->suspendingAt.store(Now(), std::memory_order_relaxed);
+
+        if(ptrace(PTRACE_INTERRUPT, thread->threadID, 0, 0)) { TraceError(thread->trace, TRACE_ERROR, errno); continue; }
+
+        interrupted[index] = true;
+
+    }
+
+    // Reap the stops of the ones we actually interrupted
+    for(uint32_t index = 0; index < count; index++) {
+
+        Opal::Saboteur* thread = group[index];
+
+        if(!interrupted[index]) continue;
+
+        while(true) {
+
+            siginfo_t information = {};
+
+            if(waitid(P_PID, thread->threadID, &information, WSTOPPED | WEXITED | __WALL)) {
+
+                // Interrupted by one of our own signals; keep waiting
+                if(errno == EINTR) continue;
+
+                TraceError(thread->trace, TRACE_ERROR, errno);
+
+                break;
+
+            }
+
+            // Gone; it can't be running
+            if(information.si_code != CLD_TRAPPED && information.si_code != CLD_STOPPED) break;
+
+            // The interrupt reports as an event stop; anything else is a
+            // signal that beat it here. Deliver the signal and keep
+            // waiting for the interrupt.
+            if((information.si_status >> 8) != PTRACE_EVENT_STOP) {
+
+                ptrace(PTRACE_CONT, thread->threadID, 0, information.si_status);
+
+                continue;
+
+            }
+
+            Suspend(thread);
+
+            break;
+
+        }
+
+    }
+
+    delete[] interrupted;
+
+    Opal::Nanoseconds elapsed = Now() - start;
+
+    if(stopped) {
+
+        *stopped = 0;
+
+        for(uint32_t index = 0; index < count; index++)
+            if(group[index]->isIn(SUSPENDED)) (*stopped)++;
+
+    }
+
+    return elapsed;
+
+}
+
+/*!
+ * Continues every suspended Opal::Saboteur in the given group.
+ * Must be invoked by the thread that created the group.
+ * \param group The Opal::Saboteurs to continue
+ * \param count The amount of Opal::Saboteurs in the group
+ * \return Opal::Nanoseconds it took to continue the group
+ */
+
+Opal::Nanoseconds Opal::Saboteur::ResumeAll(Opal::Saboteur** group, uint32_t count) {
+
+    Opal::Nanoseconds start = Now();
+
+    for(uint32_t index = 0; index < count; index++)
+        if(group[index]->isIn(SUSPENDED)) Resume(group[index]);
+
+    return Now() - start;
+
+}
+
+/*!
+ * Adds the given latency histogram of every Opal::Saboteur in the
+ * given group to the given Opal::Histogram. Members that don't
+ * record histograms are skipped. Any thread may aggregate.
+ * \param group The Opal::Saboteurs to aggregate
+ * \param count The amount of Opal::Saboteurs in the group
+ * \param histogram The HISTOGRAM_* to aggregate
+ * \param into The Opal::Histogram to add them to
+ * \return the amount of members that were added
+ */
+
+uint32_t Opal::Saboteur::MergeHistograms(Opal::Saboteur** group, uint32_t count, uint32_t histogram, Opal::Histogram& into) {
+
+    uint32_t merged = 0;
+
+    for(uint32_t index = 0; index < count; index++) {
+
+        const Opal::Histogram* source = group[index]->getHistogram(histogram);
+
+        if(source) { into.merge(*source); merged++; }
+
+    }
+
+    return merged;
+
+}
+
+/// ---------------
+/// Private Methods
+
+/*!
+ * Checks the internal state for any matches of the given value.
+ * If the value matches, then a corresponding exception is thrown.
+ * \param state The Opal::State to check.
+ */
+
+void Opal::Saboteur::checkErrorState(Opal::State state) {
+
+    // A single snapshot; we don't want to hold anyone up.
+    Opal::State current = this->state.load(std::memory_order_acquire);
+
+    // If the Opal::Saboteur is being swapped, throw a
+    // Opal::Saboteur::SaboteurIsSwappingException.
+    if(Matches(state, SWAPPING) && current == SWAPPING)
+        throw Opal::Saboteur::SaboteurIsSwappingException();
+
+    // Check if the process is finished
+    if(Matches(state, TERMINATED) && current == TERMINATED)
+        throw Opal::Saboteur::SaboteurFinishedException();
+
+    uint64_t sysResult = 0;GetProcessId(sysResult)
+
+    // Check thread id against the instances thread id here
+    // If the thread id's match, throw a Opal::Saboteur::SaboteurSwapSelfException
+    if(Matches(state, SELF_SWAP) && threadID == sysResult)
+        throw Opal::Saboteur::SaboteurSwapSelfException();
+
+    // Check if the thread is calling this itself
+    if(Matches(state, SELF_SUSPEND) && threadID == sysResult)
+        throw Opal::Saboteur::SaboteurSuspendSelfException();
+
+}
+
+/*!
+ * Sets the current state of the Opal::Saboteur. If the Opal::Saboteur
+ * has an observer, the Opal::Saboteur will notify it of the state
+ * mutation once the transition has succeeded. Transitions that are
+ * not permitted from the current state are ignored.
+ * \param state the Opal::State value to set.
+ */
+
+Opal::Saboteur& Opal::Saboteur::setStateTo(Opal::State state) {
+
+    Opal::State current = this->state.load(std::memory_order_acquire);
+    Opal::State next    = state;
+
+    do {
+
+        if(current == state || !IsTransition(current, state)) return *this;
+
+        // A resuming Opal::Saboteur goes back to whatever it was doing
+        // before it was suspended.
+        if(state == RESUMING) next = resumeState.load(std::memory_order_relaxed);
+
+        // Remember where we came from so we know where to resume.
+        else if(state == SUSPENDED) resumeState.store(current ? current : STARTED, std::memory_order_relaxed);
+
+    } while(!this->state.compare_exchange_weak(current, next,
+                std::memory_order_acq_rel, std::memory_order_acquire));
+
+    TraceState(trace, TRACE_STATE, next);
+
+    measure(current, state);
+
+    Opal::EventRing* eventRing = this->eventRing.load(std::memory_order_acquire);
+
+    // Leave the observer to whoever drains the record; only
+    // transitions someone would hear about are worth the room.
+    if(eventRing) { if(dispatch ? (events & EventOf(state)) : observer != 0) eventRing->record(state); }
+
+    else notify(state);
+
+    return *this;
+
+}
+
+/*!
+ * Records the latencies the transition between the given Opal::States
+ * completes. The creation is always timed, so it's recorded even if
+ * the histograms are set after the thread first waits; everything
+ * else is only timed while they're recorded. A resumed Opal::Saboteur
+ * goes back to what it was doing, so its' run time covers the
+ * suspension.
+ * \param previous The Opal::State transitioned from
+ * \param state The Opal::State transitioned to
+ */
+
+void Opal::Saboteur::measure(Opal::State previous, Opal::State state) {
+
+    Opal::Histogram* histograms = this->histograms.load(std::memory_order_acquire);
+
+    switch(state) {
+
+        case CREATED: createdAt.store(Now(), std::memory_order_relaxed); return;
+
+        case WAITING: {
+
+            Opal::Nanoseconds createdAt = this->createdAt.load(std::memory_order_relaxed) ? this->createdAt.exchange(0) : 0;
+
+            // Whoever sets the histograms picks up a latency we leave behind
+            if(createdAt) createLatency.store(Now() - createdAt);
+
+            if(!histograms) return;
+
+            Opal::Nanoseconds latency = createdAt ? createLatency.exchange(0) : 0;
+
+            if(latency) histograms[HISTOGRAM_CREATE].record(latency);
+
+            if(previous == STARTED && startedAt) histograms[HISTOGRAM_RUN].record(Now() - startedAt);
+
+            startedAt = 0;
+
+            return;
+
+        }
+
+        case STARTED: {
+
+            if(!histograms) return;
+
+            startedAt = Now();
+
+            if(queuedAt && startedAt > queuedAt) histograms[HISTOGRAM_QUEUED].record(startedAt - queuedAt);
+
+            queuedAt = 0;
+
+            return;
+
+        }
+
+        case SUSPENDED: {
+
+            Opal::Nanoseconds suspendingAt = histograms ? this->suspendingAt.exchange(0, std::memory_order_relaxed) : 0;
+
+            if(suspendingAt) histograms[HISTOGRAM_SUSPEND].record(Now() - suspendingAt);
+
+            return;
+
+        }
+
+        case RESUMING: if(histograms) resumingAt.store(Now(), std::memory_order_relaxed); return;
+
+        default: return;
+
+    }
+
+}
+
+/*!
+ * Notifies the observer, if any, of the given Opal::State.
+ * \param state The Opal::State transitioned to
+ */
+
+void Opal::Saboteur::notify(Opal::State state) {
+
+    // A static observer only hears about the events it consumes
+    if(dispatch) { if(events & EventOf(state)) dispatch(staticObserver, Indirect(this), state); }
+
+    // Check if there's an observer to notify
+    else if(observer) switch(state) {
+
+        case CREATED    : observer->OnCreated(Indirect(this))   ; break;
+
+        case WAITING    : observer->OnWaiting(Indirect(this))   ; break;
+
+        case STARTED    : observer->OnStarted(Indirect(this))   ; break;
+
+        case SUSPENDED  : observer->OnSuspended(Indirect(this)) ; break;
+
+        case RESUMING   : observer->OnResume(Indirect(this))    ; break;
+
+        case SUICIDE    : observer->OnSuicide(Indirect(this))   ; break;
+
+        case TERMINATED : observer->OnTerminated(Indirect(this)); break;
+
+        default: break;
+
+    }
+
+}
+
+/*!
+ * Returns a Opal::Flag indicating if the Opal::Saboteur
+ * is in the given state.
+ * \param state The state to inspect
+ * \return Opal::Flag denoting if the Opal::Saboteur is
+ * in the given state.
+ */
+
+Opal::Flag Opal::Saboteur::isIn(Opal::State state) {
+
+    // Return the masked state
+    return !(this->state.load(std::memory_order_acquire) ^ state);
+
+}
+
+/*!
+ * Returns the value of the last address the Opal::Saboteur
+ * resumed execution or will continue execution from a suspended
+ * state. This value is updated when either the link data is swapped
+ * or the Opal::Saboteur is suspended. This method will check the
+ * internal state of the Opal::Saboteur for a SWAPPING state, and
+ * if it matches, it will throw a Opal::Saboteur::SaboteurIsSwappingException.
+ * \return void pointer representing the address of the last
+ * address the Opal::Saboteur resumed execution, or will resume
+ * execution from a suspended state.
+ */
+
+void* Opal::Saboteur::getExecutionAddress() {
+
+    // Otherwise, return the value.
+    return executionAddress;
+
+}
+
+/*!
+ * Replaces the current executing code with the given code.
+ * The Opal::Saboteur must be suspended before retrieving
+ * results.
+ * \param executionAddress The address of the instruction
+ * to replace.
+ */
+
+void Opal::Saboteur::setExecutionAddress(void* executionAddress) { /* Empty */ }
+
+/// --------------
+/// Public Methods
+
+/*!
+ * Swaps the Opal::Saboteur's resume and return
+ * address and returns the previous resume and return address
+ * as contained in a Opal::Saboteur::Link instance. This
+ * method interrupts the Opal::Saboteur, preserves the current
+ * state of the data, sets the new data, and returns
+ * a copy of the previous data. Important. This method should be invoked
+ * only by another thread, never the thread that corresponds with
+ * the Opal::Saboteur instance otherwise a Opal::Saboteur::SaboteurSwapSelf
+ * exception is thrown. If this method is invoked while the Opal::Saboteur
+ * is in its' finished state, it will throw a Opal::Saboteur::SaboteurFinishedException.
+ * \param The execution address to swap with the current execution address.
+ * \param resume Opal::Flag denoting if the thread should continue execution
+ * after swapping the execution address.
+ * \return previous execution address
+ */
+
+void* Opal::Saboteur::swap(void* executionAddress, Opal::Flag resume) {
+
+    // Check for terminated, self swap, self suspend, and suicide
+    checkErrorState(TERMINATED | SELF_SWAP | SELF_SUSPEND | SUICIDE);
+
+    // If the Opal::Saboteur is not suspended, suspend it.
+    if(!isIn(SUSPENDED)) Suspend(this);
+
+    // Get the previous execution address
+    void* previous = getExecutionAddress();
+
+    // Overwrite the current execution address.
+    setExecutionAddress(executionAddress);
+
+    // Wake the Opal::Saboteur in case it's parked
+    Unpark(this);
+
+    // Resume execution
+    if(resume) Resume(this);
+
+    // Finally, return the previous data
+    return previous;
+
+}
+
+/*!
+ * Pushes the given execution address to the highest priority (current)
+ * position, effectively holding off on executing the code
+ * that was being executed at the time of invocation, if
+ * the Opal::Saboteur was executing. This method will
+ * suspend the Opal::Saboteur.
+ * \param executionAddress The execution address to push
+ * \param resume Opal::Flag denoting if the Opal::Saboteur
+ * should be resumed after the completion of the operation.
+ */
+
+void Opal::Saboteur::push(void* executionAddress, Opal::Flag resume) {
+
+    // Ideally we:
+    // 1. Get the register contents of the Opal::Saboteur
+    // 2. Extract the value of the rip
+    // 3. Update the PathDeterminant with the record corresponding with the execution
+    // 4. Create a new record with the given execution address
+    // 5. Update the Opal::Saboteur's rip register with the execution address
+    // 6. Resume the thread.
+    // This is all fine and dandy when the thread is executing, but when the Opal::Saboteur
+    // is in a waiting state, we simply acquire a state lock and push the new execution address
+    // onto the PathDeterminant. Why? Because we want Opal::Saboteur::Execution to be pushed
+    // onto the stack in case execution of code is completed and the thread goes back to
+    // its' waiting state.
+
+    // Throw an error if this thread invokes this function
+    TraceState(trace, TRACE_PUSH, executionAddress);
+
+    // The signal handler does the rest
+    if(redirectMode.load(std::memory_order_acquire) == REDIRECT_SIGNAL) {
+
+        if(!paths.push(executionAddress)) throw Opal::Saboteur::SaboteurPathsFullException();
+
+        Preempt(this);
+
+        return;
+
+    }
+
+    // Grab the RIP and update the latest record in the PathDeterminant.
+
+    // Push the given execution address to the front so it can be
+    // executed immediately. This will cause the Opal::Saboteur
+    // to execute as soon as its' resumed since it's either in its'
+    // waiting state (It will transition to starting) or its' running.
+    // Before we leave, we check for those states and update the instruction
+    // register if it's in a running state so it can execute where we
+    // specified. Important caveat: This is where we would be update
+    // the activation records for each process.
+
+    // Check the thread's state first; If it's waiting, we only update the
+    // PathDeterminant. No mutex since the Opal::Saboteur is suspended
+    if(isIn(WAITING) || true) {
+
+        // Note to self: Store previous state before suspension.
+        if(!paths.push(executionAddress)) throw Opal::Saboteur::SaboteurPathsFullException();
+
+        // Wake the Opal::Saboteur in case it's parked
+        Unpark(this);
+
+    }
+
+    else {
+
+        // Retrieve the register set
+        Opal::Registers* registers = RegistersOf(this);
+
+        if(!registers) throw Opal::Saboteur::SaboteurRegistersException();
+
+        // Set the rip register to the code that should be executed.
+        registers->setInstructionPointer(executionAddress);
+
+        // Set the registers after modification.
+        SetRegistersOf(this);
+
+    }
+
+    // We know that the Opal::Saboteur is suspended at this point.
+    // The user could have wanted to keep the Opal::Saboteur suspended
+    // and it would be real annoying to start it without their discretion.
+    if(resume) Resume(this);
+
+}
+
+/*!
+ * Places the given execution address at what might be considered
+ * the lowest priority of the Opal::Saboteur's PathDeterminant.
+ * The Opal::PathDeterminant is a queue at its' lowest priority, so
+ * the execution address will be placed last. Any number of threads
+ * may place at once.
+ * \param executionAddress The execution address to place
+ * \param resume Opal::Flag denoting if the Opal::Saboteur
+ * should be resumed after the completion of the operation.
+ * \return the placed execution address, or null if the
+ * Opal::PathDeterminant is full.
+ */
+
+void* Opal::Saboteur::place(void* executionAddress, Opal::Flag resume) {
+
+    TraceState(trace, TRACE_PUSH, executionAddress);
+
+    if(!paths.place(executionAddress)) return 0;
+
+    // Wake the Opal::Saboteur in case it's parked
+    Unpark(this);
+
+    if(resume) Resume(this);
+
+    return executionAddress;
+
+}
+
+/*!
+ * Pushes the given Opal::Task to the highest priority position.
+ * The Opal::Task is stored in the Opal::Saboteur's paths, so small
+ * closures don't allocate. In REDIRECT_SIGNAL mode, running code is
+ * preempted by the Opal::Task; otherwise it runs once the running
+ * code returns.
+ * \param task The Opal::Task to push
+ * \param resume Opal::Flag denoting if the Opal::Saboteur
+ * should be resumed after the completion of the operation.
+ * \throws SaboteurPathsFullException if there's no room for the Opal::Task.
+ */
+
+void Opal::Saboteur::push(Opal::Task&& task, Opal::Flag resume) {
+
+    TraceState(trace, TRACE_PUSH, 0);
+
+    if(!paths.push(std::move(task))) throw Opal::Saboteur::SaboteurPathsFullException();
+
+    if(redirectMode.load(std::memory_order_acquire) == REDIRECT_SIGNAL) Preempt(this);
+
+    // Wake the Opal::Saboteur in case it's parked
+    else Unpark(this);
+
+    if(resume) Resume(this);
+
+}
+
+/*!
+ * Places the given Opal::Task at the lowest priority position.
+ * The Opal::Task is stored in the Opal::Saboteur's paths, so small
+ * closures don't allocate. Any number of threads may place at once.
+ * \param task The Opal::Task to place; left untouched if there's no room
+ * \param resume Opal::Flag denoting if the Opal::Saboteur
+ * should be resumed after the completion of the operation.
+ * \return Opal::Flag denoting if the Opal::Task was placed; false if
+ * the Opal::PathDeterminant is full.
+ */
+
+Opal::Flag Opal::Saboteur::place(Opal::Task&& task, Opal::Flag resume) {
+
+    TraceState(trace, TRACE_PUSH, 0);
+
+    if(!paths.place(std::move(task))) return false;
+
+    // Wake the Opal::Saboteur in case it's parked
+    Unpark(this);
+
+    if(resume) Resume(this);
+
+    return true;
+
+}
+
+/*!
+ * Spawns a green task that runs the given Opal::Task on the
+ * Opal::Saboteur, behind whatever is in the paths.
+ * \param task The Opal::Task the green task runs
+ * \throws GreenTaskCreateFailureException if no green stack could be mapped.
+ */
+
+void Opal::Saboteur::spawn(Opal::Task&& task) {
+
+    TraceState(trace, TRACE_PUSH, 0);
+
+    enqueue(Opal::GreenTask::Create(std::move(task), this));
+
+}
+
+/*!
+ * Queues the given green task on the Opal::Saboteur. A green task
+ * that relinquishes is queued again by the Opal::Saboteur itself,
+ * which doesn't need waking.
+ * \param task The green task to queue
+ * \param wake Opal::Flag denoting if the Opal::Saboteur should be woken
+ */
+
+void Opal::Saboteur::enqueue(Opal::GreenTask* task, Opal::Flag wake) {
+
+    greens.push(task);
+
+    // Wake the Opal::Saboteur in case it's parked
+    if(wake) Unpark(this);
+
+}
+
+/*!
+ * Queues the given green task behind every green task that's ready.
+ * Preempted green tasks get a queue of their own; the one they'd be
+ * preempted out of might be waiting on a push they interrupted.
+ * \param task The green task to demote
+ */
+
+void Opal::Saboteur::demote(Opal::GreenTask* task) {
+
+    demoted.push(task);
+
+}
+
+/*!
+ * Moves the green task the Opal::Saboteur is running to the given
+ * Opal::Saboteur. The thread is stopped and its' registers read; they
+ * and the green stack from the stack pointer up are the checkpoint of
+ * the task. Green tasks own their stacks and every thread shares the
+ * address space, so the stack moves by reference and nothing in it
+ * needs rebasing. The registers are rewritten the way a time slice
+ * diverts a green task, except to Opal::GreenTask::Migrate, which
+ * switches it out to the target; the trampoline keeps every register
+ * the task had and gives them back on the target.
+ *
+ * A system call the stop interrupted is restarted by hand, since the
+ * kernel would restart it at the trampoline otherwise; one that
+ * restarts from the thread's own restart block can't move, nor can
+ * code running on the Opal::Saboteur's own stack, which it'd return
+ * into.
+ * \param target The Opal::Saboteur to move the green task to
+ * \return Opal::Flag denoting if a green task is being moved
+ */
+
+Opal::Flag Opal::Saboteur::migrate(Opal::Saboteur* target) {
+
+    if(!target || target == this) return false;
+
+    Opal::Nanoseconds stoppedAt = Now();
+    Opal::Flag        suspended = isIn(SUSPENDED);
+
+    if(!RegistersOf(this)) return false;
 
-    std::cout << "Resuming process" << std::endl;
+    user_regs_struct& values  = registers.getValues();
+    uint8_t*          pointer = reinterpret_cast<uint8_t*>(values.rsp);
+    uint8_t*          base    = reinterpret_cast<uint8_t*>(stack);
+    Opal::GreenTask*  task    = Opal::GreenTask::Of(pointer);
+    int64_t           result  = static_cast<int64_t>(values.rax);
+    Opal::Flag        call    = static_cast<int64_t>(values.orig_rax) >= 0;
+    Opal::Flag        moved   = false;
 
-    // We know that the Opal::Saboteur is suspended at this point.
-    // The user could have wanted to keep the Opal::Saboteur suspended
-    // and it would be real annoying to start it without their discretion.
-    if(resume) Resume(this);
+    // Only the green task the Opal::Saboteur is running, off its' own
+    // stack, with room for the trampoline below the interrupted frame
+    if(executionAddress == Opal::PathDeterminant::Green(task) &&
+       (pointer < base || pointer >= base + stackSize) &&
+       (values.rsp & (Opal::GreenTask::StackSize - 1)) >= SliceHeadroom &&
+       !(call && result == -ERESTART_RESTARTBLOCK)) {
+
+        // Stopped in a system call; restart it once the task is back
+        if(call) {
+
+            if(result == -ERESTARTSYS || result == -ERESTARTNOINTR || result == -ERESTARTNOHAND) {
+
+                values.rax  = values.orig_rax;
+                values.rip -= 2;
+
+            }
+
+            values.orig_rax = -1;
+
+        }
+
+        uint64_t* top = reinterpret_cast<uint64_t*>(values.rsp - 128) - 3;
+
+        // Same frame Divert leaves for the trampoline
+        top[2] = values.rip;
+        top[1] = 0;
+        top[0] = reinterpret_cast<uint64_t>(&Opal::GreenTask::Migrate);
+
+        values.rsp = reinterpret_cast<uint64_t>(top);
+        values.rip = reinterpret_cast<uint64_t>(&RedirectTrampoline);
+
+        if((moved = SetRegistersOf(this))) task->handOver(target, stoppedAt);
+
+    }
+
+    if(!suspended) Resume(this);
+
+    return moved;
 
 }
 
 /*!
- * Places the given execution address at what might be considered
- * the lowest priority of the Opal::Saboteur's PathDeterminant.
- * For example, if a queue is being used as the underlying structure
- * of the Opal::PathDeterminant, then the execution address
- * will be placed last.
- * \param executionAddress The execution address to push
- * \param resume Opal::Flag denoting if the Opal::Saboteur
- * should be resumed after the completion of the operation.
+ * Records a green task that migrated to the Opal::Saboteur, and how
+ * long it was paused for; the time from its' previous Opal::Saboteur
+ * stopping until it's continued here.
+ * \param pause The time the green task was paused for
  */
 
-void* Opal::Saboteur::place(void* executionAddress, Opal::Flag resume) { /* Empty */ }
+void Opal::Saboteur::migrated(Opal::Nanoseconds pause) {
+
+    Opal::Histogram* histograms = this->histograms.load(std::memory_order_acquire);
+
+    migrations.fetch_add(1, std::memory_order_relaxed);
+
+    if(histograms) histograms[HISTOGRAM_MIGRATE].record(pause);
+
+}
 
 /*!
- * Cancels the currently executing code (highest priority) the
- * Opal::Saboteur was executing and returns the address of the
- * instruction at the moment the Opal::thread
- * was suspended. This method will suspend the Opal::Saboteur.
- * \param executionAddress The execution address to push
+ * Cancels the highest priority execution address the
+ * Opal::Saboteur has yet to execute and returns it. Code
+ * that is already executing runs to completion. A cancelled
+ * Opal::Task is destroyed; what's returned for it only denotes
+ * that something was cancelled.
  * \param resume Opal::Flag denoting if the Opal::Saboteur
  * should be resumed after the completion of the operation.
+ * \return the cancelled execution address, or null if the
+ * Opal::PathDeterminant is empty.
  */
 
-void* Opal::Saboteur::pop(Opal::Flag resume) { /* Empty */ }
+void* Opal::Saboteur::pop(Opal::Flag resume) {
+
+    void* executionAddress = paths.take();
+
+    // Nobody gets to run a cancelled task
+    Opal::PathDeterminant::Discard(executionAddress);
+
+    if(resume) Resume(this);
+
+    return executionAddress;
+
+}
 
 /*!
  * Suspends the thread. This method should be invoked by another
@@ -691,6 +2048,458 @@ void Opal::Saboteur::suspend() { Suspend(this); }
 
 void Opal::Saboteur::resume() { Resume(this); }
 
+/*!
+ * Sets the Opal::Saboteur to terminate once it has finished
+ * executing its' assigned code and wakes it if it's parked.
+ */
+
+void Opal::Saboteur::terminate() {
+
+    setStateTo(TERMINATE);
+
+    Unpark(this);
+
+}
+
+/*!
+ * Waits for the thread of the Opal::Saboteur to exit, however it
+ * got there. Sleeps on the thread id the kernel clears once the
+ * thread is off its' stack, so the wait costs a single wake.
+ * \param timeout The most time to wait, zero waits indefinitely
+ * \return Opal::Flag denoting if the thread has exited
+ */
+
+Opal::Flag Opal::Saboteur::join(Opal::Nanoseconds timeout) {
+
+    Opal::Nanoseconds deadline = timeout ? Now() + timeout : 0;
+
+    for(uint32_t id = childID.load(); id; id = childID.load()) {
+
+        struct timespec  remaining = { 0, 0 };
+        struct timespec* limit     = 0;
+
+        if(deadline) {
+
+            Opal::Nanoseconds now = Now();
+
+            if(now >= deadline) return false;
+
+            remaining.tv_sec  = (deadline - now) / 1000000000;
+            remaining.tv_nsec = (deadline - now) % 1000000000;
+            limit             = &remaining;
+
+        }
+
+        // The kernel's CLONE_CHILD_CLEARTID wake is a shared one; a
+        // private wait on the same word would never hear it.
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&childID), FUTEX_WAIT, id, limit, 0, 0);
+
+    }
+
+    return true;
+
+}
+
+/*!
+ * Sets the amount of spins an idle Opal::Saboteur performs
+ * before it parks. A value of zero parks immediately.
+ * \param spinBudget The amount of spins
+ */
+
+void Opal::Saboteur::setSpinBudget(uint32_t spinBudget) { this->spinBudget = spinBudget; }
+
+/*!
+ * Returns the time elapsed between the most recent wake
+ * request and the Opal::Saboteur waking up from its' parked state.
+ * \return Opal::Nanoseconds of the most recent wake
+ */
+
+Opal::Nanoseconds Opal::Saboteur::getWakeLatency() { return wakeLatency.load(); }
+
+/*!
+ * Returns the cpus and NUMA node the Opal::Saboteur lives on.
+ * \return Reference to the Opal::Placement
+ */
+
+const Opal::Placement& Opal::Saboteur::getPlacement() { return placement; }
+
+/*!
+ * Lets the Opal::Saboteur steal from the given group once it runs
+ * out of execution addresses of its' own. The group may include the
+ * Opal::Saboteur itself and must outlive it.
+ * \param siblings The Opal::Saboteurs to steal from
+ * \param count The amount of Opal::Saboteurs in the group
+ */
+
+void Opal::Saboteur::setSiblings(Opal::Saboteur** siblings, uint32_t count) {
+
+    // The count has to be in place before the group is visible
+    this->siblingCount = count;
+    this->siblings.store(count ? siblings : 0, std::memory_order_release);
+
+    // Have a look at the group if we're asleep
+    Unpark(this);
+
+}
+
+/*!
+ * Sets how push() redirects the Opal::Saboteur while it's running.
+ * Switching to REDIRECT_SIGNAL detaches the thread from ptrace, so
+ * it must be invoked by the thread that created the Opal::Saboteur,
+ * and there's no switching back. A detached Opal::Saboteur can't be
+ * suspended through ptrace.
+ * \param mode REDIRECT_PTRACE or REDIRECT_SIGNAL
+ */
+
+void Opal::Saboteur::setRedirectMode(uint32_t mode) {
+
+    // Nothing to do, or nothing we can do
+    if(mode != REDIRECT_SIGNAL || redirectMode.load() == REDIRECT_SIGNAL) return;
+
+    // Only the first one through installs the handler
+    static const int installed = InstallRedirect();
+
+    if(installed) throw Opal::Saboteur::ProcessAttachFailureException();
+
+    uint8_t* signalStack = static_cast<uint8_t*>(Stacks.allocate(SignalStackSize));
+
+    if(!signalStack) throw Opal::Saboteur::SaboteurCreateFailureException();
+
+    placement.bind(signalStack, SignalStackSize);
+
+    this->signalStack.store(signalStack, std::memory_order_release);
+
+    // While traced, every signal stops the thread until we forward it;
+    // stop it one last time and let it go.
+    if(threadID && !isIn(TERMINATED)) {
+
+        if(!isIn(SUSPENDED)) {
+
+            ptrace(PTRACE_INTERRUPT, threadID, 0, 0);
+
+            waitpid(threadID, 0, __WALL);
+
+        }
+
+        if(ptrace(PTRACE_DETACH, threadID, 0, 0)) TraceError(trace, TRACE_ERROR, errno);
+
+    }
+
+    redirectMode.store(REDIRECT_SIGNAL, std::memory_order_release);
+
+    // Have it pick up the signal stack
+    Unpark(this);
+
+}
+
+/*!
+ * Returns how push() redirects the Opal::Saboteur while it's running.
+ * \return REDIRECT_PTRACE or REDIRECT_SIGNAL
+ */
+
+uint32_t Opal::Saboteur::getRedirectMode() { return redirectMode.load(std::memory_order_acquire); }
+
+/*!
+ * Sets the cpu time the Opal::Saboteur's running code gets before
+ * it's preempted in favor of whatever is waiting behind it. Switches
+ * the Opal::Saboteur to REDIRECT_SIGNAL first, so the same rules
+ * apply; it must be invoked by the thread that created the
+ * Opal::Saboteur, and the thread stays detached from ptrace even once
+ * the slice is turned off. The Opal::Saboteur arms its' own timer the
+ * next time it looks for work.
+ * \param slice The time slice in nanoseconds, 0 to turn it off
+ */
+
+void Opal::Saboteur::setTimeSlice(Opal::Nanoseconds slice) {
+
+    if(slice) setRedirectMode(REDIRECT_SIGNAL);
+
+    timeSlice.store(slice, std::memory_order_release);
+
+    // Have it pick up the time slice
+    Unpark(this);
+
+}
+
+/*!
+ * Returns the cpu time the Opal::Saboteur's running code gets
+ * before it's preempted.
+ * \return the time slice in nanoseconds, 0 if there is none
+ */
+
+Opal::Nanoseconds Opal::Saboteur::getTimeSlice() { return timeSlice.load(std::memory_order_relaxed); }
+
+/*!
+ * Returns the amount of times the Opal::Saboteur's running code
+ * was preempted at the end of its' time slice.
+ * \return the amount of preemptions
+ */
+
+uint64_t Opal::Saboteur::getPreemptions() { return preemptions.load(std::memory_order_relaxed); }
+
+/*!
+ * Returns the amount of green tasks that migrated to the
+ * Opal::Saboteur.
+ * \return the amount of migrations
+ */
+
+uint64_t Opal::Saboteur::getMigrations() { return migrations.load(std::memory_order_relaxed); }
+
+/*!
+ * Returns the pidfd of the Opal::Saboteur's thread. It becomes
+ * readable once the thread exits; it's closed once the Opal::Saboteur
+ * is destroyed.
+ * \return the pidfd, or -1 if the thread has none
+ */
+
+int32_t Opal::Saboteur::getPidfd() { return pidfd; }
+
+/*!
+ * Returns the id of the Opal::Saboteur's thread.
+ * \return the thread id, or 0 if there is no thread
+ */
+
+Opal::ThreadID Opal::Saboteur::getThreadID() { return threadID; }
+
+/*!
+ * Opens a perf_event group on the Opal::Saboteur's thread. From then
+ * on, what every execution address it runs costs is attributed to
+ * where the address came from. The counters only exist once; opening
+ * them again returns whether they're open.
+ * \param software Denotes if context switches and page faults are
+ * counted too; without them, the thread reads its' counters with rdpmc.
+ * \return Opal::Flag denoting if any counter could be opened
+ */
+
+Opal::Flag Opal::Saboteur::openCounters(Opal::Flag software) {
+
+    // Already counting
+    if(counters.load()) return true;
+
+    if(!threadID) return false;
+
+    Opal::Counters* counters = new Opal::Counters();
+    Opal::Counters* expected = 0;
+
+    // The worker does the attributing, so the table belongs on its' node
+    placement.bind(counters, sizeof(Opal::Counters));
+
+    if(!counters->open(threadID, software) || !this->counters.compare_exchange_strong(expected, counters)) {
+
+        delete counters;
+
+        return expected != 0;
+
+    }
+
+    return true;
+
+}
+
+/*!
+ * Returns the hardware counters of the Opal::Saboteur's thread.
+ * \return Pointer to the Opal::Counters, or null if openCounters()
+ * hasn't succeeded
+ */
+
+Opal::Counters* Opal::Saboteur::getCounters() { return counters.load(std::memory_order_acquire); }
+
+/*!
+ * Sets the Opal::Saboteur to record its' latency histograms. There's
+ * no switching back. Execution addresses queued from here on are
+ * stamped, and the creation latency is recorded if the thread has
+ * already waited.
+ */
+
+void Opal::Saboteur::setHistograms() {
+
+    // Already recording
+    if(histograms.load()) return;
+
+    Opal::Histogram* histograms = new Opal::Histogram[HISTOGRAM_COUNT];
+    Opal::Histogram* expected   = 0;
+
+    // The worker does most of the recording
+    placement.bind(histograms, sizeof(Opal::Histogram) * HISTOGRAM_COUNT);
+
+    // Someone else beat us to it
+    if(!this->histograms.compare_exchange_strong(expected, histograms)) { delete[] histograms; return; }
+
+    paths.setStamping(true);
+
+    Opal::Nanoseconds latency = createLatency.exchange(0);
+
+    if(latency) histograms[HISTOGRAM_CREATE].record(latency);
+
+}
+
+/*!
+ * Returns the given latency histogram of the Opal::Saboteur.
+ * \param histogram The HISTOGRAM_* to return
+ * \return Pointer to the Opal::Histogram, or null if the Opal::Saboteur
+ * doesn't record histograms
+ */
+
+const Opal::Histogram* Opal::Saboteur::getHistogram(uint32_t histogram) {
+
+    Opal::Histogram* histograms = this->histograms.load(std::memory_order_acquire);
+
+    return histograms && histogram < HISTOGRAM_COUNT ? &histograms[histogram] : 0;
+
+}
+
+/*!
+ * Sets the Opal::Saboteur to record its' transitions instead of
+ * notifying the observer on the spot. The recorded transitions are
+ * delivered by whichever thread invokes dispatchEvents(). There's
+ * no switching back.
+ */
+
+void Opal::Saboteur::setAsyncEvents() {
+
+    // Already recording
+    if(eventRing.load()) return;
+
+    Opal::EventRing* eventRing = new Opal::EventRing();
+    Opal::EventRing* expected  = 0;
+
+    // The worker does the recording, so the ring belongs on its' node
+    placement.bind(eventRing, sizeof(Opal::EventRing));
+
+    // Someone else beat us to it
+    if(!this->eventRing.compare_exchange_strong(expected, eventRing)) delete eventRing;
+
+}
+
+/*!
+ * Delivers up to the given amount of recorded transitions to the
+ * observer, oldest first, on the invoking thread. Only one thread
+ * may dispatch at a time.
+ * \param count The most transitions to deliver
+ * \return the amount of transitions consumed from the record
+ */
+
+uint64_t Opal::Saboteur::dispatchEvents(uint64_t count) {
+
+    Opal::EventRing* eventRing = this->eventRing.load(std::memory_order_acquire);
+
+    // Nothing's recorded
+    if(!eventRing) return 0;
+
+    Opal::State states[64];
+    uint64_t    delivered = 0;
+
+    // Deliver in batches; the record keeps filling while we're at it
+    while(delivered < count) {
+
+        uint64_t batch = eventRing->drain(states, count - delivered < 64 ? count - delivered : 64);
+
+        if(!batch) break;
+
+        for(uint64_t index = 0; index < batch; index++) notify(states[index]);
+
+        delivered += batch;
+
+    }
+
+    return delivered;
+
+}
+
+/*!
+ * Returns the amount of transitions that weren't delivered
+ * because the record was full.
+ * \return the amount of dropped transitions
+ */
+
+uint64_t Opal::Saboteur::getDroppedEvents() {
+
+    Opal::EventRing* eventRing = this->eventRing.load(std::memory_order_acquire);
+
+    return eventRing ? eventRing->getDropped() : 0;
+
+}
+
+/*!
+ * Returns the amount of transitions that weren't delivered
+ * because they were coalesced away.
+ * \return the amount of coalesced transitions
+ */
+
+uint64_t Opal::Saboteur::getCoalescedEvents() {
+
+    Opal::EventRing* eventRing = this->eventRing.load(std::memory_order_acquire);
+
+    return eventRing ? eventRing->getCoalesced() : 0;
+
+}
+
+/*!
+ * Stops the Opal::Saboteur and takes a snapshot of its' registers.
+ * The snapshot is owned by the Opal::Saboteur and is overwritten by
+ * the next one; nothing is allocated. Must be invoked by the thread
+ * that created the Opal::Saboteur.
+ * \param resume Opal::Flag denoting if the Opal::Saboteur should be
+ * resumed once the snapshot is taken.
+ * \return Reference to the snapshot
+ * \throws SaboteurRegistersException if the registers couldn't be read.
+ */
+
+Opal::Registers& Opal::Saboteur::snapshot(Opal::Flag resume) {
+
+    if(!RegistersOf(this)) throw Opal::Saboteur::SaboteurRegistersException();
+
+    if(resume) Resume(this);
+
+    return registers;
+
+}
+
+/*!
+ * Writes the snapshot (presumably modified) back to the stopped
+ * Opal::Saboteur's registers. Must be invoked by the thread that
+ * created the Opal::Saboteur.
+ * \param resume Opal::Flag denoting if the Opal::Saboteur should be
+ * resumed once the registers are written.
+ * \throws SaboteurRegistersException if the registers couldn't be written.
+ */
+
+void Opal::Saboteur::restore(Opal::Flag resume) {
+
+    if(!SetRegistersOf(this)) throw Opal::Saboteur::SaboteurRegistersException();
+
+    if(resume) Resume(this);
+
+}
+
+/*!
+ * Returns the amount of execution addresses the Opal::Saboteur
+ * stole from its' siblings.
+ * \return the amount of steals
+ */
+
+uint64_t Opal::Saboteur::getSteals() { return steals.load(std::memory_order_relaxed); }
+
+/*!
+ * Returns the amount of times the Opal::Saboteur went looking for
+ * something to steal and came up empty.
+ * \return the amount of failed steal attempts
+ */
+
+uint64_t Opal::Saboteur::getStealFailures() { return stealFailures.load(std::memory_order_relaxed); }
+
+#if OPAL_TRACE_LEVEL > OPAL_TRACE_NONE
+
+/*!
+ * Returns the Opal::TraceRing the Opal::Saboteur records
+ * its' trace points to. Only available when tracing is compiled in.
+ * \return Opal::TraceRing of the Opal::Saboteur
+ */
+
+Opal::TraceRing& Opal::Saboteur::getTrace() { return trace; }
+
+#endif
+
 /*!
  * Returns a flag denoting if the Opal::Saboteur will terminate
  * after executing all of the assigned code.
@@ -0,0 +1,420 @@
+/*!
+ * Opal::SaboteurPool implementation
+ *
+ * \author: Carlos L. Cuenca
+ */
+
+#include<SaboteurPool.hpp>
+
+/// ------------
+/// Constructors
+
+/*!
+ * Primary Constructor. Spawns the given amount of workers, each
+ * with the given stack size. A size of zero spawns a single worker.
+ * \param size The amount of workers
+ * \param observer The Opal::SaboteurObserver that receives callbacks
+ * from every worker
+ * \param stackSize The usable size of each worker's stack in bytes
+ * \param stealing Denotes if idle workers steal from busy ones
+ */
+
+Opal::SaboteurPool::SaboteurPool(uint32_t size, Opal::SaboteurObserver* observer, uint64_t stackSize, Opal::Flag stealing):
+workers(0), size(size ? size : 1), next(0) { spawn(0, observer, stackSize, stealing); }
+
+/*!
+ * Spawns one worker per given placement, pinned to its' cpus with
+ * its' stack on its' node. Without placements, the pool lays out
+ * one worker per physical core the creator may run on.
+ * \param placements The placement of each worker, or null
+ * \param count The amount of placements; the most workers to
+ * lay out without placements, zero for every core
+ * \param observer The Opal::SaboteurObserver that receives callbacks
+ * from every worker
+ * \param stackSize The usable size of each worker's stack in bytes
+ * \param stealing Denotes if idle workers steal from busy ones
+ */
+
+Opal::SaboteurPool::SaboteurPool(const Opal::Placement* placements, uint32_t count, Opal::SaboteurObserver* observer,
+                                 uint64_t stackSize, Opal::Flag stealing):
+workers(0), size(count), next(0) {
+
+    if(placements && count) { spawn(placements, observer, stackSize, stealing); return; }
+
+    Opal::Placement* layout = new Opal::Placement[CPU_SETSIZE];
+
+    size = Opal::Placement::PhysicalCores(layout, count ? count : CPU_SETSIZE);
+
+    // Couldn't make out the topology; still give them a worker
+    if(!size) size = 1;
+
+    try { spawn(layout, observer, stackSize, stealing); }
+
+    catch(...) { delete[] layout; throw; }
+
+    delete[] layout;
+
+}
+
+/*!
+ * Deconstructor. Resumes any suspended worker, then terminates every
+ * worker once it has finished its' remaining execution addresses and
+ * releases it.
+ */
+
+Opal::SaboteurPool::~SaboteurPool() {
+
+    // A stopped worker can't see the terminate request; let it go first
+    Opal::Saboteur::ResumeAll(workers, size);
+
+    // Let every worker wind down at once before we wait on any of them
+    for(uint32_t index = 0; index < size; index++)
+        workers[index]->terminate();
+
+    // Stealing workers look at each other's deques until they
+    // terminate, so nobody gets released before everyone's done
+    for(uint32_t index = 0; index < size; index++)
+        workers[index]->join();
+
+    for(uint32_t index = 0; index < size; index++)
+        delete workers[index];
+
+    delete[] workers;
+
+    workers = 0;
+    size    = 0;
+
+}
+
+/// ---------------
+/// Private Methods
+
+/*!
+ * Spawns a worker for each slot of the pool.
+ * \param placements The placement of each worker, or null
+ * \param observer The Opal::SaboteurObserver of every worker
+ * \param stackSize The usable size of each worker's stack in bytes
+ * \param stealing Denotes if idle workers steal from busy ones
+ * \throws SaboteurCreateFailureException if a worker couldn't be
+ * created; every worker that was is released first.
+ */
+
+void Opal::SaboteurPool::spawn(const Opal::Placement* placements, Opal::SaboteurObserver* observer,
+                               uint64_t stackSize, Opal::Flag stealing) {
+
+    workers = new Opal::Saboteur*[size]();
+
+    // Workers start out with nothing to execute, so they go
+    // straight to waiting; they're started up as one batch
+    try { Opal::Saboteur::Spawn(workers, size, observer, stackSize, placements); }
+
+    catch(...) {
+
+        // The deconstructor won't run for us; release whoever made it
+        for(uint32_t index = 0; index < size && workers[index]; index++)
+            workers[index]->terminate();
+
+        for(uint32_t index = 0; index < size && workers[index]; index++)
+            delete workers[index];
+
+        delete[] workers;
+
+        workers = 0;
+        size    = 0;
+
+        throw;
+
+    }
+
+    // Every worker exists now, so they can see each other
+    if(stealing) for(uint32_t index = 0; index < size; index++)
+        workers[index]->setSiblings(workers, size);
+
+}
+
+/*!
+ * Makes sure every worker is still attached through ptrace.
+ * \throws SaboteurPoolDetachedException if a worker has a time slice.
+ */
+
+void Opal::SaboteurPool::checkAttached() {
+
+    for(uint32_t index = 0; index < size; index++)
+        if(workers[index]->getRedirectMode() == REDIRECT_SIGNAL) throw SaboteurPoolDetachedException();
+
+}
+
+/// --------------
+/// Public Methods
+
+/*!
+ * Submits the given execution address to the pool. A waiting
+ * worker is preferred; if every worker is busy, the address is
+ * placed behind the work of the next worker in turn.
+ * Any number of threads may submit at once.
+ * \param executionAddress The execution address to submit
+ * \throws SaboteurPoolFullException if every worker is full.
+ */
+
+void Opal::SaboteurPool::submit(void* executionAddress) {
+
+    // Spread the submissions so concurrent submitters don't
+    // all land on the same waiting worker
+    uint32_t start = next.fetch_add(1, std::memory_order_relaxed) % size;
+
+    // Look for a worker with nothing to do
+    for(uint32_t offset = 0; offset < size; offset++) {
+
+        Opal::Saboteur* worker = workers[(start + offset) % size];
+
+        if(worker->isWaiting() && worker->place(executionAddress)) return;
+
+    }
+
+    // Everyone's busy; queue it behind the first worker with room
+    for(uint32_t offset = 0; offset < size; offset++)
+        if(workers[(start + offset) % size]->place(executionAddress)) return;
+
+    throw SaboteurPoolFullException();
+
+}
+
+/*!
+ * Submits the given Opal::Task to the pool, the same way an
+ * execution address is. The Opal::Task is stored in the paths of
+ * whichever worker takes it.
+ * \param task The Opal::Task to submit
+ * \throws SaboteurPoolFullException if every worker is full.
+ */
+
+void Opal::SaboteurPool::submit(Opal::Task&& task) {
+
+    uint32_t start = next.fetch_add(1, std::memory_order_relaxed) % size;
+
+    // A place that fails leaves the task with us, so we can try the next
+    for(uint32_t offset = 0; offset < size; offset++) {
+
+        Opal::Saboteur* worker = workers[(start + offset) % size];
+
+        if(worker->isWaiting() && worker->place(std::move(task))) return;
+
+    }
+
+    for(uint32_t offset = 0; offset < size; offset++)
+        if(workers[(start + offset) % size]->place(std::move(task))) return;
+
+    throw SaboteurPoolFullException();
+
+}
+
+/*!
+ * Spawns a green task that runs the given Opal::Task on the next
+ * worker in turn.
+ * \param task The Opal::Task the green task runs
+ * \throws GreenTaskCreateFailureException if no green stack could be mapped.
+ */
+
+void Opal::SaboteurPool::spawn(Opal::Task&& task) {
+
+    workers[next.fetch_add(1, std::memory_order_relaxed) % size]->spawn(std::move(task));
+
+}
+
+/*!
+ * Stops every worker in the pool at once and returns once they
+ * have all provably stopped. Must be invoked by the thread that
+ * created the pool.
+ * \return Opal::Nanoseconds the barrier took
+ * \throws SaboteurPoolDetachedException if a worker has a time slice.
+ * \throws SaboteurPoolSuspendFailureException if a worker didn't
+ * stop; the ones that did are continued first.
+ */
+
+Opal::Nanoseconds Opal::SaboteurPool::suspendAll() {
+
+    // A detached worker would just be skipped; say so instead
+    checkAttached();
+
+    uint32_t          stopped = 0;
+    Opal::Nanoseconds elapsed = Opal::Saboteur::SuspendAll(workers, size, &stopped);
+
+    // Half a barrier is no barrier; don't leave the rest stopped
+    if(stopped != size) {
+
+        Opal::Saboteur::ResumeAll(workers, size);
+
+        throw SaboteurPoolSuspendFailureException();
+
+    }
+
+    return elapsed;
+
+}
+
+/*!
+ * Continues every worker stopped by suspendAll(). Must be invoked
+ * by the thread that created the pool.
+ * \return Opal::Nanoseconds it took to continue the pool
+ * \throws SaboteurPoolDetachedException if a worker has a time slice.
+ */
+
+Opal::Nanoseconds Opal::SaboteurPool::resumeAll() {
+
+    checkAttached();
+
+    return Opal::Saboteur::ResumeAll(workers, size);
+
+}
+
+/*!
+ * Sets the cpu time every worker's running code gets before it's
+ * preempted in favor of whatever is waiting behind it. Every worker
+ * is detached from ptrace for good, even once the slice is turned
+ * off, so suspendAll(), resumeAll() and migrate() throw from then on.
+ * \param slice The time slice in nanoseconds, 0 to turn it off
+ */
+
+void Opal::SaboteurPool::setTimeSlice(Opal::Nanoseconds slice) {
+
+    for(uint32_t index = 0; index < size; index++)
+        workers[index]->setTimeSlice(slice);
+
+}
+
+/*!
+ * Returns the amount of workers in the pool.
+ * \return the amount of workers
+ */
+
+uint32_t Opal::SaboteurPool::getSize() {
+
+    return size;
+
+}
+
+/*!
+ * Returns the worker at the given index.
+ * \param index The index of the worker
+ * \return Reference to the worker
+ */
+
+Opal::Saboteur& Opal::SaboteurPool::getWorker(uint32_t index) {
+
+    return *workers[index % size];
+
+}
+
+/*!
+ * Returns the amount of execution addresses the workers stole
+ * from each other.
+ * \return the amount of steals
+ */
+
+uint64_t Opal::SaboteurPool::getSteals() {
+
+    uint64_t steals = 0;
+
+    for(uint32_t index = 0; index < size; index++)
+        steals += workers[index]->getSteals();
+
+    return steals;
+
+}
+
+/*!
+ * Returns the amount of times a worker went looking for something
+ * to steal and came up empty.
+ * \return the amount of failed steal attempts
+ */
+
+uint64_t Opal::SaboteurPool::getStealFailures() {
+
+    uint64_t stealFailures = 0;
+
+    for(uint32_t index = 0; index < size; index++)
+        stealFailures += workers[index]->getStealFailures();
+
+    return stealFailures;
+
+}
+
+/*!
+ * Returns the amount of times a worker's running code was
+ * preempted at the end of its' time slice.
+ * \return the amount of preemptions
+ */
+
+uint64_t Opal::SaboteurPool::getPreemptions() {
+
+    uint64_t preemptions = 0;
+
+    for(uint32_t index = 0; index < size; index++)
+        preemptions += workers[index]->getPreemptions();
+
+    return preemptions;
+
+}
+
+/*!
+ * Opens a perf_event group on every worker. Each worker attributes
+ * what it runs on its' own; read them through getWorker().
+ * \param software Denotes if context switches and page faults are counted
+ * \return Opal::Flag denoting if every worker is being counted
+ */
+
+Opal::Flag Opal::SaboteurPool::openCounters(Opal::Flag software) {
+
+    Opal::Flag opened = true;
+
+    for(uint32_t index = 0; index < size; index++)
+        opened = workers[index]->openCounters(software) && opened;
+
+    return opened;
+
+}
+
+/*!
+ * Sets every worker to record its' latency histograms.
+ */
+
+void Opal::SaboteurPool::setHistograms() {
+
+    for(uint32_t index = 0; index < size; index++)
+        workers[index]->setHistograms();
+
+}
+
+/*!
+ * Adds the given latency histogram of every worker to the given
+ * Opal::Histogram. Any thread may aggregate.
+ * \param histogram The HISTOGRAM_* to aggregate
+ * \param into The Opal::Histogram to add them to
+ * \return Opal::Flag denoting if any worker records histograms
+ */
+
+Opal::Flag Opal::SaboteurPool::getHistogram(uint32_t histogram, Opal::Histogram& into) {
+
+    return Opal::Saboteur::MergeHistograms(workers, size, histogram, into) != 0;
+
+}
+
+/*!
+ * Moves the green task the given worker is running to another one,
+ * so a worker that's stuck behind a long green task can hand it off
+ * while it runs. Must be invoked by the thread that created the
+ * Opal::SaboteurPool.
+ * \param from The index of the worker to move the green task off
+ * \param to The index of the worker to move it to
+ * \return Opal::Flag denoting if a green task is being moved
+ * \throws SaboteurPoolDetachedException if the worker has a time slice.
+ */
+
+Opal::Flag Opal::SaboteurPool::migrate(uint32_t from, uint32_t to) {
+
+    if(from >= size || to >= size) return false;
+
+    if(workers[from]->getRedirectMode() == REDIRECT_SIGNAL) throw SaboteurPoolDetachedException();
+
+    return workers[from]->migrate(workers[to]);
+
+}
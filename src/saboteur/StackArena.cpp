@@ -0,0 +1,284 @@
+/*!
+ * Opal::StackArena implementation
+ *
+ * \author: Carlos L. Cuenca
+ */
+
+#include<StackArena.hpp>
+
+/// -----------------
+/// Macro Definitions
+
+// Omit from documentation
+// Older headers don't know about it; the kernel does since 5.14
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif
+
+/// ------------
+/// Constructors
+
+/*!
+ * Initializes the Opal::StackArena with the given guard size.
+ * The guard size is rounded up to a page boundary, a guard
+ * size of zero uses a single page.
+ * \param guardSize The size of the PROT_NONE region below each stack
+ */
+
+Opal::StackArena::StackArena(uint64_t guardSize):
+mutex(), released(0), guardSize(PageAligned(guardSize ? guardSize : 1)), mapped(0), reused(0) { /* Empty */ }
+
+/*!
+ * Deconstructor. Unmaps every released stack. Stacks that
+ * are still handed out are left alone.
+ */
+
+Opal::StackArena::~StackArena() {
+
+    // Acquire the lock
+    Opal::Lock<Opal::Mutex> lock(mutex);
+
+    while(released) {
+
+        Stack*   stack = released;
+        uint64_t size  = stack->size;
+
+        released = stack->next;
+
+        // The record lives at the top of the stack; the mapping
+        // starts at the bottom of the guard region.
+        munmap(reinterpret_cast<uint8_t*>(stack) + sizeof(Stack) - size - guardSize, size + guardSize);
+
+    }
+
+}
+
+/// ------------------------
+/// Private Static Functions
+
+/*!
+ * Returns the given size rounded up to a page boundary.
+ * \param size The size in bytes
+ * \return the rounded size in bytes
+ */
+
+uint64_t Opal::StackArena::PageAligned(uint64_t size) {
+
+    static const uint64_t pageSize = sysconf(_SC_PAGESIZE);
+
+    return (size + pageSize - 1) & ~(pageSize - 1);
+
+}
+
+/*!
+ * Returns the usable size a stack with the given size and options
+ * is mapped with; whole pages, or whole huge pages for STACK_HUGE.
+ * \param size The size in bytes
+ * \param options The options of the stack
+ * \return the mapped size in bytes
+ */
+
+uint64_t Opal::StackArena::MappedSize(uint64_t size, uint32_t options) {
+
+    if(options & STACK_HUGE) return (size + HugePageSize - 1) & ~(HugePageSize - 1);
+
+    return PageAligned(size);
+
+}
+
+/// ---------------
+/// Private Methods
+
+/*!
+ * Maps a stack of the given mapped size with the guard below it.
+ * A huge stack is mapped inside a PROT_NONE reservation large enough
+ * to align it to a huge page; whatever's left of the reservation
+ * below the stack is its' guard. Explicit huge pages are tried first,
+ * transparent ones after. Either way MAP_STACK is left out, since the
+ * kernel takes it as a hint against huge pages.
+ * \param size The mapped size of the stack in bytes
+ * \param options The options of the stack
+ * \return Pointer to the lowest usable address of the stack, or
+ * null if the mapping failed.
+ */
+
+uint8_t* Opal::StackArena::map(uint64_t size, uint32_t options) {
+
+    static const uint64_t pageSize = sysconf(_SC_PAGESIZE);
+
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | ((options & STACK_NORESERVE) ? MAP_NORESERVE : 0);
+
+    uint8_t* stack = 0;
+
+    if(options & STACK_HUGE) {
+
+        const uint64_t reserved = guardSize + size + HugePageSize;
+
+        uint8_t* region = static_cast<uint8_t*>(mmap(0, reserved, PROT_NONE,
+                                                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0));
+
+        if(region == MAP_FAILED) return 0;
+
+        stack = reinterpret_cast<uint8_t*>((reinterpret_cast<uint64_t>(region) + guardSize + HugePageSize - 1) & ~(HugePageSize - 1));
+
+        if(mmap(stack, size, PROT_READ | PROT_WRITE, flags | MAP_FIXED | MAP_HUGETLB, -1, 0) == MAP_FAILED) {
+
+            if(mmap(stack, size, PROT_READ | PROT_WRITE, flags | MAP_FIXED, -1, 0) == MAP_FAILED) {
+
+                munmap(region, reserved);
+
+                return 0;
+
+            }
+
+            madvise(stack, size, MADV_HUGEPAGE);
+
+        }
+
+        // Keep the guard right below the stack and nothing else
+        uint8_t* guard = stack - guardSize;
+        uint8_t* end   = stack + size;
+
+        if(guard != region)          munmap(region, guard - region);
+        if(end != region + reserved) munmap(end, region + reserved - end);
+
+    } else {
+
+        // Map the stack and its' guard in one go
+        uint8_t* region = static_cast<uint8_t*>(mmap(0, size + guardSize, PROT_READ | PROT_WRITE,
+                                                     flags | MAP_STACK, -1, 0));
+
+        if(region == MAP_FAILED) return 0;
+
+        // The stack grows down, so the guard goes at the bottom
+        if(mprotect(region, guardSize, PROT_NONE)) {
+
+            munmap(region, size + guardSize);
+
+            return 0;
+
+        }
+
+        stack = region + guardSize;
+
+    }
+
+    // Fault everything in now, one page at a time if the kernel can't
+    if((options & STACK_PREFAULT) && madvise(stack, size, MADV_POPULATE_WRITE))
+        for(uint8_t* page = stack; page < stack + size; page += pageSize)
+            *reinterpret_cast<volatile uint8_t*>(page) = 0;
+
+    return stack;
+
+}
+
+/// --------------
+/// Public Methods
+
+/*!
+ * Returns the lowest usable address of a stack with at least the
+ * given size. A released stack of the same size and options is
+ * reused if one exists, otherwise a new one is mapped.
+ * \param size The usable size of the stack in bytes
+ * \param options The STACK_* options of the stack
+ * \return Pointer to the lowest usable address of the stack, or
+ * null if the mapping failed.
+ */
+
+void* Opal::StackArena::allocate(uint64_t size, uint32_t options) {
+
+    size = MappedSize(size, options);
+
+    {
+
+        // Acquire the lock
+        Opal::Lock<Opal::Mutex> lock(mutex);
+
+        // Look for a released stack of the same size
+        for(Stack** link = &released; *link; link = &(*link)->next) {
+
+            if((*link)->size != size || (*link)->options != options) continue;
+
+            Stack* stack = *link;
+
+            *link = stack->next;
+
+            reused++;
+
+            return reinterpret_cast<uint8_t*>(stack) + sizeof(Stack) - size;
+
+        }
+
+    }
+
+    // Nothing to reuse
+    uint8_t* stack = map(size, options);
+
+    if(!stack) return 0;
+
+    // Acquire the lock
+    Opal::Lock<Opal::Mutex> lock(mutex);
+
+    mapped++;
+
+    return stack;
+
+}
+
+/*!
+ * Returns the given stack to the free list so it can be
+ * handed out again.
+ * \param stack The lowest usable address of the stack
+ * \param size The usable size the stack was allocated with
+ * \param options The options the stack was allocated with
+ */
+
+void Opal::StackArena::release(void* stack, uint64_t size, uint32_t options) {
+
+    // Leave if there's nothing to release
+    if(!stack) return;
+
+    size = MappedSize(size, options);
+
+    // Record the stack at its' top
+    Stack* record = reinterpret_cast<Stack*>(static_cast<uint8_t*>(stack) + size - sizeof(Stack));
+
+    record->size    = size;
+    record->options = options;
+
+    // Acquire the lock
+    Opal::Lock<Opal::Mutex> lock(mutex);
+
+    record->next = released;
+    released     = record;
+
+}
+
+/*!
+ * Returns the amount of stacks that have been mapped.
+ * \return the amount of mapped stacks
+ */
+
+uint64_t Opal::StackArena::getMapped() {
+
+    // Acquire the lock
+    Opal::Lock<Opal::Mutex> lock(mutex);
+
+    return mapped;
+
+}
+
+/*!
+ * Returns the amount of stacks that were handed out from
+ * the free list.
+ * \return the amount of reused stacks
+ */
+
+uint64_t Opal::StackArena::getReused() {
+
+    // Acquire the lock
+    Opal::Lock<Opal::Mutex> lock(mutex);
+
+    return reused;
+
+}
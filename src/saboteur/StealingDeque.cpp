@@ -0,0 +1,145 @@
+/*!
+ * Opal::StealingDeque implementation
+ *
+ * \author: Carlos L. Cuenca
+ */
+
+#include<StealingDeque.hpp>
+
+/// ------------
+/// Constructors
+
+/*!
+ * Default Constructor. Initializes an empty Opal::StealingDeque.
+ */
+
+Opal::StealingDeque::StealingDeque(): top(0), bottom(0), addresses(), queued() {
+
+    for(int64_t index = 0; index < Capacity; index++) {
+
+        addresses[index].store(0, std::memory_order_relaxed);
+        queued[index].store(0, std::memory_order_relaxed);
+
+    }
+
+}
+
+/// --------------
+/// Public Methods
+
+/*!
+ * Pushes the given execution address at the bottom. Owner only.
+ * \param address The execution address
+ * \param queued When the address was queued, zero if unknown
+ * \return Opal::Flag denoting if the address was pushed; false if
+ * the Opal::StealingDeque is full.
+ */
+
+Opal::Flag Opal::StealingDeque::push(void* address, Opal::Nanoseconds queued) {
+
+    int64_t bottom = this->bottom.load(std::memory_order_relaxed);
+    int64_t top    = this->top.load(std::memory_order_acquire);
+
+    // No more room
+    if(bottom - top >= Capacity) return false;
+
+    addresses[bottom & (Capacity - 1)].store(address, std::memory_order_relaxed);
+    this->queued[bottom & (Capacity - 1)].store(queued, std::memory_order_relaxed);
+
+    // Publish the address before the thieves can see the new bottom
+    std::atomic_thread_fence(std::memory_order_release);
+
+    this->bottom.store(bottom + 1, std::memory_order_relaxed);
+
+    return true;
+
+}
+
+/*!
+ * Removes and returns the execution address at the bottom. Owner only.
+ * \param queued Where the time the address was queued goes, if anywhere
+ * \return the execution address, or null if there is none.
+ */
+
+void* Opal::StealingDeque::pop(Opal::Nanoseconds* queued) {
+
+    int64_t bottom = this->bottom.load(std::memory_order_relaxed) - 1;
+
+    // Claim the bottom before we look at the top, so a thief
+    // racing us for the last address sees the claim.
+    this->bottom.store(bottom, std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    int64_t top     = this->top.load(std::memory_order_relaxed);
+    void*   address = 0;
+
+    if(top <= bottom) {
+
+        address = addresses[bottom & (Capacity - 1)].load(std::memory_order_relaxed);
+
+        if(queued) *queued = this->queued[bottom & (Capacity - 1)].load(std::memory_order_relaxed);
+
+        // Not the last one, so no thief can reach it
+        if(top != bottom) return address;
+
+        // The last one; whoever moves the top gets it
+        if(!this->top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            address = 0;
+
+    }
+
+    // Empty, or we raced for the last one; either way it's empty now
+    this->bottom.store(bottom + 1, std::memory_order_relaxed);
+
+    return address;
+
+}
+
+/*!
+ * Removes and returns the execution address at the top. Any
+ * thread may steal, the owner included; that's how it takes its'
+ * oldest address.
+ * \param queued Where the time the address was queued goes, if anywhere
+ * \return the execution address, or null if there is none or
+ * another thread got to it first.
+ */
+
+void* Opal::StealingDeque::steal(Opal::Nanoseconds* queued) {
+
+    int64_t top = this->top.load(std::memory_order_acquire);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    int64_t bottom = this->bottom.load(std::memory_order_acquire);
+
+    // Nothing to steal
+    if(top >= bottom) return 0;
+
+    void*             address = addresses[top & (Capacity - 1)].load(std::memory_order_relaxed);
+    Opal::Nanoseconds stamp   = this->queued[top & (Capacity - 1)].load(std::memory_order_relaxed);
+
+    // Someone else (the owner or another thief) got to it first
+    if(!this->top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return 0;
+
+    if(queued) *queued = stamp;
+
+    return address;
+
+}
+
+/*!
+ * Returns the amount of execution addresses held. The value is
+ * exact for the owner and a snapshot for everyone else.
+ * \return the amount of execution addresses
+ */
+
+int64_t Opal::StealingDeque::getSize() {
+
+    int64_t bottom = this->bottom.load(std::memory_order_acquire);
+    int64_t top    = this->top.load(std::memory_order_acquire);
+
+    return bottom > top ? bottom - top : 0;
+
+}
@@ -0,0 +1,295 @@
+/*!
+ * Opal::Supervisor implementation
+ *
+ * \author: Carlos L. Cuenca
+ */
+
+#include<csignal>
+#include<sys/epoll.h>
+#include<sys/signalfd.h>
+#include<sys/wait.h>
+#include<unistd.h>
+#include<Supervisor.hpp>
+#include<Saboteur.hpp>
+
+/// -----------------
+/// Macro Definitions
+
+// Omit from documentation
+// Spreads the given thread id over the given amount of slots
+#define SlotIndex(threadID, capacity) \
+    static_cast<uint32_t>((static_cast<uint32_t>(threadID) * 0x9E3779B9U) >> (32 - __builtin_ctz(capacity)))
+
+// The most events taken off the epoll set at once
+#define ReadyCapacity       64
+
+/// ------------
+/// Constructors
+
+/*!
+ * Initializes an Opal::Supervisor that watches up to the given amount
+ * of Opal::Saboteurs at once. SIGCHLD is blocked on the invoking thread;
+ * its' default is to be discarded, and a signalfd only reads a signal
+ * that's blocked. Every other thread of the process must block it too,
+ * which is simplest by constructing the Opal::Supervisor before any of
+ * them.
+ * \param capacity The most Opal::Saboteurs watched at once
+ * \throws SupervisorCreateFailureException if the epoll set or the
+ * signalfd couldn't be created.
+ */
+
+Opal::Supervisor::Supervisor(uint32_t capacity): epoll(-1), signals(-1), capacity(2), slots(0), watched(0) {
+
+    // Twice the room it needs, so probes stay short
+    while(this->capacity < 2 * capacity) this->capacity <<= 1;
+
+    sigset_t mask;
+
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+
+    pthread_sigmask(SIG_BLOCK, &mask, 0);
+
+    epoll   = epoll_create1(EPOLL_CLOEXEC);
+    signals = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+
+    // The signalfd is the only member of the set without an Opal::Saboteur
+    epoll_event event = {};
+
+    event.events   = EPOLLIN;
+    event.data.ptr = 0;
+
+    if(epoll < 0 || signals < 0 || epoll_ctl(epoll, EPOLL_CTL_ADD, signals, &event)) {
+
+        if(epoll   >= 0) close(epoll);
+        if(signals >= 0) close(signals);
+
+        throw SupervisorCreateFailureException();
+
+    }
+
+    slots = new Slot[this->capacity]();
+
+}
+
+/*!
+ * Deconstructor. Closes the epoll set and the signalfd. SIGCHLD
+ * stays blocked.
+ */
+
+Opal::Supervisor::~Supervisor() {
+
+    close(epoll);
+    close(signals);
+
+    delete[] slots;
+
+}
+
+/// ---------------
+/// Private Methods
+
+/*!
+ * Returns the slot of the given thread id. Probes go past slots that
+ * were let go, and stop at the first one that was never used.
+ * \param threadID The thread id
+ * \return Pointer to the slot, or null if it isn't watched
+ */
+
+Opal::Supervisor::Slot* Opal::Supervisor::slotOf(pid_t threadID) {
+
+    for(uint32_t probe = 0, index = SlotIndex(threadID, capacity); probe < capacity; probe++, index = (index + 1) & (capacity - 1)) {
+
+        pid_t claimed = slots[index].threadID.load(std::memory_order_acquire);
+
+        if(claimed == threadID) return &slots[index];
+
+        if(!claimed) return 0;
+
+    }
+
+    return 0;
+
+}
+
+/*!
+ * Stops watching the given slot's Opal::Saboteur, unless somebody
+ * else got to it first. The slot is left for the next watch.
+ * \param slot The slot
+ * \param saboteur The Opal::Saboteur in it
+ * \return Opal::Flag denoting if it was let go here
+ */
+
+Opal::Flag Opal::Supervisor::release(Slot* slot, Opal::Saboteur* saboteur) {
+
+    if(!slot->saboteur.compare_exchange_strong(saboteur, 0)) return false;
+
+    epoll_ctl(epoll, EPOLL_CTL_DEL, saboteur->getPidfd(), 0);
+
+    slot->threadID.store(-1, std::memory_order_release);
+
+    watched.fetch_sub(1, std::memory_order_relaxed);
+
+    return true;
+
+}
+
+/// --------------
+/// Public Methods
+
+/*!
+ * Starts watching the given Opal::Saboteur. Its' pidfd joins the epoll
+ * set, so its' exit wakes the Opal::Supervisor; its' thread id gets a
+ * slot, so its' stops can be told apart. Any thread may watch.
+ * \param saboteur The Opal::Saboteur to watch
+ * \return Opal::Flag denoting if it's being watched; not if it has no
+ * pidfd, it's already watched or there's no room
+ */
+
+Opal::Flag Opal::Supervisor::watch(Opal::Saboteur* saboteur) {
+
+    if(!saboteur || saboteur->getPidfd() < 0 || !saboteur->getThreadID()) return false;
+
+    if(watched.fetch_add(1, std::memory_order_relaxed) >= capacity / 2) {
+
+        watched.fetch_sub(1, std::memory_order_relaxed);
+
+        return false;
+
+    }
+
+    pid_t threadID = static_cast<pid_t>(saboteur->getThreadID());
+
+    for(uint32_t probe = 0, index = SlotIndex(threadID, capacity); probe < capacity; probe++, index = (index + 1) & (capacity - 1)) {
+
+        Slot&  slot    = slots[index];
+        pid_t  claimed = slot.threadID.load(std::memory_order_acquire);
+
+        if(claimed > 0 || !slot.threadID.compare_exchange_strong(claimed, threadID)) continue;
+
+        slot.saboteur.store(saboteur, std::memory_order_release);
+
+        epoll_event event = {};
+
+        event.events   = EPOLLIN;
+        event.data.ptr = saboteur;
+
+        if(!epoll_ctl(epoll, EPOLL_CTL_ADD, saboteur->getPidfd(), &event)) return true;
+
+        // Already in the set; it's watched under another slot
+
+        slot.saboteur.store(0, std::memory_order_relaxed);
+        slot.threadID.store(-1, std::memory_order_release);
+
+        break;
+
+    }
+
+    watched.fetch_sub(1, std::memory_order_relaxed);
+
+    return false;
+
+}
+
+/*!
+ * Stops watching the given Opal::Saboteur.
+ * \param saboteur The Opal::Saboteur to stop watching
+ * \return Opal::Flag denoting if it was being watched
+ */
+
+Opal::Flag Opal::Supervisor::unwatch(Opal::Saboteur* saboteur) {
+
+    Slot* slot = saboteur ? slotOf(static_cast<pid_t>(saboteur->getThreadID())) : 0;
+
+    return slot && release(slot, saboteur);
+
+}
+
+/*!
+ * Waits until something happens to the watched Opal::Saboteurs, or
+ * until the timeout runs out, and collects what happened. An exited
+ * Opal::Saboteur's pidfd is readable; its' status is peeked at and
+ * it's let go. Every SIGCHLD since the last look names a thread that
+ * stopped or exited; the ones that are still stopped are reported.
+ * Nothing is reaped.
+ *
+ * SIGCHLD doesn't queue; a stop that lands while an earlier one's
+ * SIGCHLD is still pending shares its' notification, so stops are
+ * reported at most once and may be missed under a burst. Exits are
+ * always reported.
+ * \param events The array to fill
+ * \param capacity The capacity of the array
+ * \param timeout The most milliseconds to wait, -1 to wait indefinitely
+ * \return the amount of events written
+ */
+
+uint32_t Opal::Supervisor::wait(Event* events, uint32_t capacity, int32_t timeout) {
+
+    epoll_event ready[ReadyCapacity];
+    uint32_t    written = 0;
+
+    if(!capacity) return 0;
+
+    int32_t count = epoll_wait(epoll, ready, capacity < ReadyCapacity ? capacity : ReadyCapacity, timeout);
+
+    for(int32_t index = 0; index < count && written < capacity; index++) {
+
+        Opal::Saboteur* saboteur = static_cast<Opal::Saboteur*>(ready[index].data.ptr);
+
+        // The signalfd; whatever doesn't fit stays readable for next time
+        if(!saboteur) {
+
+            signalfd_siginfo information;
+
+            while(written < capacity && read(signals, &information, sizeof(information)) == sizeof(information)) {
+
+                Slot*           slot    = slotOf(static_cast<pid_t>(information.ssi_pid));
+                Opal::Saboteur* stopped = slot ? slot->saboteur.load(std::memory_order_acquire) : 0;
+                siginfo_t       stop    = {};
+
+                if(!stopped) continue;
+
+                // Reaped meanwhile, or not a stop at all
+                if(waitid(P_PID, information.ssi_pid, &stop, WSTOPPED | WNOHANG | WNOWAIT | __WALL) || !stop.si_pid) continue;
+
+                if(stop.si_code != CLD_TRAPPED && stop.si_code != CLD_STOPPED) continue;
+
+                events[written++] = Event{ stopped, SUPERVISOR_STOPPED, stop.si_status };
+
+            }
+
+            continue;
+
+        }
+
+        pid_t     threadID    = static_cast<pid_t>(saboteur->getThreadID());
+        Slot*     slot        = slotOf(threadID);
+        siginfo_t information = {};
+
+        waitid(P_PID, threadID, &information, WEXITED | WNOHANG | WNOWAIT | __WALL);
+
+        // Let go of it here, unless it was unwatched meanwhile
+        if(!slot || !release(slot, saboteur)) continue;
+
+        events[written++] = Event{ saboteur, SUPERVISOR_EXITED, information.si_status };
+
+    }
+
+    return written;
+
+}
+
+/*!
+ * Returns the amount of Opal::Saboteurs being watched.
+ * \return the amount of watched Opal::Saboteurs
+ */
+
+uint32_t Opal::Supervisor::getWatched() { return watched.load(std::memory_order_relaxed); }
+
+/*!
+ * Returns the epoll set. It's readable whenever wait() has something
+ * to collect.
+ * \return the epoll descriptor
+ */
+
+int32_t Opal::Supervisor::getDescriptor() { return epoll; }